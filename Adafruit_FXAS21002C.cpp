@@ -33,12 +33,52 @@
  *
  */
 #include "Adafruit_FXAS21002C.h"
+#include "FXAS21002C_Trace.h"
+#include "FXAS21002C_Transport.h"
 #include <limits.h>
+#include <new>
 
 /***************************************************************************
  PRIVATE FUNCTIONS
  ***************************************************************************/
 
+/**************************************************************************/
+/*!
+     @brief  Starts the bus device, checks the device ID and initializes the
+             hardware.
+
+     @return True if the device was successfully initialized, otherwise false.
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::beginDevice() {
+#ifndef FXAS21002C_HOST
+  if (i2c_dev && !(_trace && _trace->replaying()) && !i2c_dev->begin())
+    return false;
+#endif
+
+  uint8_t id = 0;
+  if (!readRegisters(GYRO_REGISTER_WHO_AM_I, &id, 1) || (id != FXAS21002C_ID))
+    return false;
+
+  return initialize();
+}
+
+/**************************************************************************/
+/*!
+     @brief  Destroys the bus device if it was created by begin(), or forgets
+             an injected one.
+*/
+/**************************************************************************/
+void Adafruit_FXAS21002C::releaseDevice() {
+#ifndef FXAS21002C_HOST
+  if (_i2c_dev_owned)
+    i2c_dev->~Adafruit_I2CDevice();
+  i2c_dev = NULL;
+  _i2c_dev_owned = false;
+#endif
+  _transport = NULL;
+}
+
 /**************************************************************************/
 /*!
      @brief  Initializes the hardware to a default state.
@@ -47,9 +87,6 @@
 */
 /**************************************************************************/
 bool Adafruit_FXAS21002C::initialize() {
-  Adafruit_BusIO_Register CTRL_REG0(i2c_dev, GYRO_REGISTER_CTRL_REG0);
-  Adafruit_BusIO_Register CTRL_REG1(i2c_dev, GYRO_REGISTER_CTRL_REG1);
-
   /* Set the range the an appropriate value */
   _range = GYRO_RANGE_250DPS;
 
@@ -59,16 +96,206 @@ bool Adafruit_FXAS21002C::initialize() {
   raw.z = 0;
 
   /* Reset then switch to active mode with 100Hz output */
-  CTRL_REG1.write(0x00);   // Standby
-  CTRL_REG1.write(1 << 6); // Reset
-  CTRL_REG0.write(0x03);   // Set full scale range to +-250 dps
-  _ODR = GYRO_ODR_100HZ;   // Update global ODR variable
-  CTRL_REG1.write(0x0E);   // Active
-  delay(100);              // 60ms + 1/ODR
+  writeRegister(GYRO_REGISTER_CTRL_REG1, 0x00);   // Standby
+  writeRegister(GYRO_REGISTER_CTRL_REG1, 1 << 6); // Reset
+  writeRegister(GYRO_REGISTER_CTRL_REG0, 0x03);   // Set range to +-250 dps
+  _ODR = GYRO_ODR_100HZ;                          // Update global ODR variable
+  _period = 10000;                                // 100Hz sample period in us
+  writeRegister(GYRO_REGISTER_CTRL_REG1, 0x0E);   // Active
+  delay(100);                                     // 60ms + 1/ODR
 
   return true;
 }
 
+#ifndef FXAS21002C_NO_FLOAT
+/**************************************************************************/
+/*!
+     @brief  Gets the sensitivity for the current full scale range.
+
+     @return The sensitivity in dps/LSB.
+*/
+/**************************************************************************/
+float Adafruit_FXAS21002C::sensitivity() {
+  switch (_range) {
+  case GYRO_RANGE_500DPS:
+    return GYRO_SENSITIVITY_500DPS;
+  case GYRO_RANGE_1000DPS:
+    return GYRO_SENSITIVITY_1000DPS;
+  case GYRO_RANGE_2000DPS:
+    return GYRO_SENSITIVITY_2000DPS;
+  default:
+    return GYRO_SENSITIVITY_250DPS;
+  }
+}
+#endif
+
+/**************************************************************************/
+/*!
+     @brief  Reads consecutive registers. All register reads go through here
+             so they can be traced and replayed.
+
+     @param  reg     The first register to read
+     @param  buffer  Receives the register contents
+     @param  len     Number of bytes to read
+
+     @return True if the bus transaction succeeded
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::readRegisters(uint8_t reg, uint8_t *buffer,
+                                        size_t len) {
+  if (_trace && _trace->replaying())
+    return _trace->replay(false, reg, buffer, len);
+
+#ifdef FXAS21002C_BUS_STATS
+  uint32_t start = micros();
+#endif
+#ifndef FXAS21002C_HOST
+  bool ok = _transport ? _transport->readRegisters(reg, buffer, len)
+                       : i2c_dev->write_then_read(&reg, 1, buffer, len);
+#else
+  bool ok = _transport && _transport->readRegisters(reg, buffer, len);
+#endif
+#ifdef FXAS21002C_BUS_STATS
+  gyroBusOp_t op = GYRO_BUS_REG_READ;
+  if (reg <= GYRO_REGISTER_OUT_Z_LSB)
+    op = (len > 7) ? GYRO_BUS_FIFO_READ : GYRO_BUS_DATA_READ;
+  recordBusTime(op, micros() - start, ok);
+#endif
+  if (_trace)
+    _trace->record(false, reg, buffer, len, ok);
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+     @brief  Writes one register. All register writes go through here so
+             they can be traced and replayed.
+
+     @param  reg    The register to write
+     @param  value  The new register value
+
+     @return True if the bus transaction succeeded
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::writeRegister(uint8_t reg, uint8_t value) {
+  if (_trace && _trace->replaying())
+    return _trace->replay(true, reg, &value, 1);
+
+#ifdef FXAS21002C_BUS_STATS
+  uint32_t start = micros();
+#endif
+  bool ok;
+#ifndef FXAS21002C_HOST
+  if (_transport) {
+    ok = _transport->writeRegister(reg, value);
+  } else {
+    uint8_t buffer[2] = {reg, value};
+    ok = i2c_dev->write(buffer, 2);
+  }
+#else
+  ok = _transport && _transport->writeRegister(reg, value);
+#endif
+#ifdef FXAS21002C_BUS_STATS
+  recordBusTime(GYRO_BUS_REG_WRITE, micros() - start, ok);
+#endif
+  if (_trace)
+    _trace->record(true, reg, &value, 1, ok);
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+     @brief  Read-modify-writes a bit field, like Adafruit_BusIO_RegisterBits
+
+     @param  reg    The register holding the field
+     @param  bits   Width of the field
+     @param  shift  Position of the field's lowest bit
+     @param  value  The new field value
+
+     @return True if both bus transactions succeeded
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::writeRegisterBits(uint8_t reg, uint8_t bits,
+                                            uint8_t shift, uint8_t value) {
+  uint8_t current;
+  if (!readRegisters(reg, &current, 1))
+    return false;
+
+  uint8_t mask = ((1 << bits) - 1) << shift;
+  return writeRegister(reg, (current & ~mask) | ((value << shift) & mask));
+}
+
+/**************************************************************************/
+/*!
+     @brief  Reads a sample, retrying failed transactions as configured with
+             setRetryPolicy(). The backoff starts at the configured delay
+             and doubles on every retry, so the worst case time is bounded.
+
+     @param  reg     The first register to read
+     @param  buffer  Receives the register contents
+     @param  len     Number of bytes to read
+
+     @return True if one of the attempts succeeded
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::readData(uint8_t reg, uint8_t *buffer, size_t len) {
+  uint32_t start = micros();
+  uint32_t backoff = _backoffUs;
+
+  for (uint8_t attempt = 0;; attempt++) {
+    uint32_t attemptStart = micros();
+    if (readRegisters(reg, buffer, len)) {
+      if (attempt) {
+        _errors.recovered++;
+        _errors.failedUs += attemptStart - start;
+      }
+      return true;
+    }
+
+    _errors.failures++;
+    if (attempt >= _maxRetries) {
+      _errors.dropped++;
+      _errors.failedUs += micros() - start;
+      return false;
+    }
+
+    _errors.retries++;
+    if (backoff) {
+      delayMicroseconds(backoff);
+      backoff = (backoff < 0x8000) ? backoff * 2 : 0xFFFF;
+    }
+  }
+}
+
+#ifdef FXAS21002C_BUS_STATS
+/**************************************************************************/
+/*!
+     @brief  Adds one transaction to the latency histogram of its type
+
+     @param  op  The operation type
+     @param  us  The transaction time in microseconds
+     @param  ok  The bus result
+*/
+/**************************************************************************/
+void Adafruit_FXAS21002C::recordBusTime(gyroBusOp_t op, uint32_t us,
+                                        bool ok) {
+  gyroBusHistogram_t *h = &_busStats[op];
+  uint8_t bucket = 0;
+  while (us >> bucket)
+    bucket++;
+  if (bucket >= FXAS21002C_BUS_BUCKETS)
+    bucket = FXAS21002C_BUS_BUCKETS - 1;
+
+  h->count++;
+  if (!ok)
+    h->failed++;
+  h->totalUs += us;
+  if (us > h->maxUs)
+    h->maxUs = us;
+  h->buckets[bucket]++;
+}
+#endif
+
 /***************************************************************************
  CONSTRUCTOR
  ***************************************************************************/
@@ -83,21 +310,22 @@ bool Adafruit_FXAS21002C::initialize() {
 /**************************************************************************/
 Adafruit_FXAS21002C::Adafruit_FXAS21002C(int32_t sensorID) {
   _sensorID = sensorID;
+#ifdef FXAS21002C_BUS_STATS
+  resetBusHistograms();
+#endif
 }
 
 /***************************************************************************
  DESTRUCTOR
  ***************************************************************************/
 
-Adafruit_FXAS21002C::~Adafruit_FXAS21002C() {
-  if (i2c_dev)
-    delete i2c_dev;
-}
+Adafruit_FXAS21002C::~Adafruit_FXAS21002C() { releaseDevice(); }
 
 /***************************************************************************
  PUBLIC FUNCTIONS
  ***************************************************************************/
 
+#ifndef FXAS21002C_HOST
 /**************************************************************************/
 /*!
     @brief  Setup the HW
@@ -110,19 +338,50 @@ Adafruit_FXAS21002C::~Adafruit_FXAS21002C() {
 /**************************************************************************/
 bool Adafruit_FXAS21002C::begin(uint8_t addr, TwoWire *wire) {
 
-  if (i2c_dev)
-    delete i2c_dev;
-  i2c_dev = new Adafruit_I2CDevice(addr, wire);
-  if (!i2c_dev->begin())
-    return false;
+  /* Construct the device in place, re-begin never touches the heap */
+  releaseDevice();
+  i2c_dev = new (_i2c_dev_storage) Adafruit_I2CDevice(addr, wire);
+  _i2c_dev_owned = true;
 
-  Adafruit_BusIO_Register WHO_AM_I(i2c_dev, GYRO_REGISTER_WHO_AM_I);
-  if (WHO_AM_I.read() != FXAS21002C_ID)
-    return false;
+  return beginDevice();
+}
 
-  return initialize();
+/**************************************************************************/
+/*!
+    @brief  Setup the HW using a bus device owned by the caller
+
+    @param i2c The I2C device the sensor is attached to. It must outlive
+           this object.
+
+    @return True if the device was successfully initialized, otherwise false.
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::begin(Adafruit_I2CDevice &i2c) {
+  releaseDevice();
+  i2c_dev = &i2c;
+
+  return beginDevice();
 }
+#endif
 
+/**************************************************************************/
+/*!
+    @brief  Setup the HW on a non-Arduino bus, e.g. FXAS21002C_LinuxI2C
+
+    @param bus The transport the sensor is attached to, already opened. It
+           must outlive this object.
+
+    @return True if the device was successfully initialized, otherwise false.
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::begin(FXAS21002C_Transport &bus) {
+  releaseDevice();
+  _transport = &bus;
+
+  return beginDevice();
+}
+
+#ifndef FXAS21002C_NO_FLOAT
 /**************************************************************************/
 /*!
     @brief  Gets the most recent sensor event
@@ -140,11 +399,6 @@ bool Adafruit_FXAS21002C::getEvent(sensors_event_t *event) {
   /* Clear the event */
   memset(event, 0, sizeof(sensors_event_t));
 
-  /* Clear the raw data placeholder */
-  raw.x = 0;
-  raw.y = 0;
-  raw.z = 0;
-
   event->version = sizeof(sensors_event_t);
   event->sensor_id = _sensorID;
   event->type = SENSOR_TYPE_GYROSCOPE;
@@ -152,51 +406,73 @@ bool Adafruit_FXAS21002C::getEvent(sensors_event_t *event) {
 
   /* Read 7 bytes from the sensor */
   uint8_t buffer[7] = {0};
-  buffer[0] = GYRO_REGISTER_STATUS;
-  i2c_dev->write_then_read(buffer, 1, buffer, 7);
+  bool ok = readData(GYRO_REGISTER_STATUS, buffer, 7);
+  _stale = !ok;
+
+  if (ok) {
+    /* Shift values to create properly formed integer */
+    raw.x = (int16_t)((buffer[1] << 8) | buffer[2]);
+    raw.y = (int16_t)((buffer[3] << 8) | buffer[4]);
+    raw.z = (int16_t)((buffer[5] << 8) | buffer[6]);
+  } else if (!_holdLastGood) {
+    /* Report zero rates, but never as a valid reading */
+    raw.x = 0;
+    raw.y = 0;
+    raw.z = 0;
+  }
 
-  /* Shift values to create properly formed integer */
-  event->gyro.x = (int16_t)((buffer[1] << 8) | buffer[2]);
-  event->gyro.y = (int16_t)((buffer[3] << 8) | buffer[4]);
-  event->gyro.z = (int16_t)((buffer[5] << 8) | buffer[6]);
+  /* Compensate values depending on the resolution and convert to rad/s */
+  float scale = sensitivity() * SENSORS_DPS_TO_RADS;
+  event->gyro.x = raw.x * scale;
+  event->gyro.y = raw.y * scale;
+  event->gyro.z = raw.z * scale;
 
-  /* Assign raw values in case someone needs them */
-  raw.x = event->gyro.x;
-  raw.y = event->gyro.y;
-  raw.z = event->gyro.z;
+  return ok;
+}
+#endif
 
-  /* Compensate values depending on the resolution */
-  switch (_range) {
-  case GYRO_RANGE_250DPS:
-    event->gyro.x *= GYRO_SENSITIVITY_250DPS;
-    event->gyro.y *= GYRO_SENSITIVITY_250DPS;
-    event->gyro.z *= GYRO_SENSITIVITY_250DPS;
-    break;
-  case GYRO_RANGE_500DPS:
-    event->gyro.x *= GYRO_SENSITIVITY_500DPS;
-    event->gyro.y *= GYRO_SENSITIVITY_500DPS;
-    event->gyro.z *= GYRO_SENSITIVITY_500DPS;
-    break;
-  case GYRO_RANGE_1000DPS:
-    event->gyro.x *= GYRO_SENSITIVITY_1000DPS;
-    event->gyro.y *= GYRO_SENSITIVITY_1000DPS;
-    event->gyro.z *= GYRO_SENSITIVITY_1000DPS;
-    break;
-  case GYRO_RANGE_2000DPS:
-    event->gyro.x *= GYRO_SENSITIVITY_2000DPS;
-    event->gyro.y *= GYRO_SENSITIVITY_2000DPS;
-    event->gyro.z *= GYRO_SENSITIVITY_2000DPS;
-    break;
-  }
+/**************************************************************************/
+/*!
+    @brief  Reads the most recent raw sample without any float conversion
+
+    @param[out] data
+                The raw gyroscope values. Unlike getEvent(), the public
+                'raw' member is left untouched. On failure 'data' is left
+                untouched too, so it still holds the last good sample.
+
+     @return True if the bus transaction succeeded, otherwise false.
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::readRaw(gyroRawData_t *data) {
+  uint8_t buffer[6];
+  _stale = !readData(GYRO_REGISTER_OUT_X_MSB, buffer, 6);
+  if (_stale)
+    return false;
 
-  /* Convert values to rad/s */
-  event->gyro.x *= SENSORS_DPS_TO_RADS;
-  event->gyro.y *= SENSORS_DPS_TO_RADS;
-  event->gyro.z *= SENSORS_DPS_TO_RADS;
+  data->x = (int16_t)((buffer[0] << 8) | buffer[1]);
+  data->y = (int16_t)((buffer[2] << 8) | buffer[3]);
+  data->z = (int16_t)((buffer[4] << 8) | buffer[5]);
 
   return true;
 }
 
+/**************************************************************************/
+/*!
+    @brief  Reads the most recent raw sample and stamps it with micros(),
+            e.g. to push it into an FXAS21002C_SampleRing
+
+    @param[out] sample
+                The timestamped raw sample
+
+     @return True if the bus transaction succeeded, otherwise false.
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::readSample(gyroSample_t *sample) {
+  sample->timestamp = micros();
+  return readRaw(&sample->data);
+}
+
+#ifndef FXAS21002C_NO_UNIFIED_SENSOR
 /**************************************************************************/
 /*!
     @brief  Gets the sensor_t data
@@ -221,7 +497,9 @@ void Adafruit_FXAS21002C::getSensor(sensor_t *sensor) {
   sensor->min_value = ((float)this->_range * -1.0) * SENSORS_DPS_TO_RADS;
   sensor->resolution = 0.0F; // TBD
 }
+#endif
 
+#ifndef FXAS21002C_NO_CONFIG
 /**************************************************************************/
 /*!
     @brief  Set the gyroscope full scale range.
@@ -229,25 +507,22 @@ void Adafruit_FXAS21002C::getSensor(sensor_t *sensor) {
 */
 /**************************************************************************/
 void Adafruit_FXAS21002C::setRange(gyroRange_t range) {
-  Adafruit_BusIO_Register CTRL_REG0(i2c_dev, GYRO_REGISTER_CTRL_REG0);
-  Adafruit_BusIO_RegisterBits range_bits(&CTRL_REG0, 2, 0);
-
   standby(true);
 
   /* write FS[1:0] bits (bits controlling the full scale range) with correct
    * values according to page 40 of the datasheet */
   switch (range) {
   case GYRO_RANGE_250DPS:
-    range_bits.write(0b11);
+    writeRegisterBits(GYRO_REGISTER_CTRL_REG0, 2, 0, 0b11);
     break;
   case GYRO_RANGE_500DPS:
-    range_bits.write(0b10);
+    writeRegisterBits(GYRO_REGISTER_CTRL_REG0, 2, 0, 0b10);
     break;
   case GYRO_RANGE_1000DPS:
-    range_bits.write(0b01);
+    writeRegisterBits(GYRO_REGISTER_CTRL_REG0, 2, 0, 0b01);
     break;
   case GYRO_RANGE_2000DPS:
-    range_bits.write(0b00);
+    writeRegisterBits(GYRO_REGISTER_CTRL_REG0, 2, 0, 0b00);
     break;
   }
 
@@ -255,6 +530,7 @@ void Adafruit_FXAS21002C::setRange(gyroRange_t range) {
 
   _range = range;
 }
+#endif
 
 /**************************************************************************/
 /*!
@@ -271,17 +547,45 @@ gyroRange_t Adafruit_FXAS21002C::getRange() { return _range; }
 */
 /**************************************************************************/
 void Adafruit_FXAS21002C::standby(boolean standby) {
-  Adafruit_BusIO_Register CTRL_REG1(i2c_dev, GYRO_REGISTER_CTRL_REG1);
-  Adafruit_BusIO_RegisterBits active_bit(&CTRL_REG1, 2, 0);
-
   if (standby) {
-    active_bit.write(0x00);
+    writeRegisterBits(GYRO_REGISTER_CTRL_REG1, 2, 0, 0x00);
     delay(100);
   } else {
-    active_bit.write(0x03);
+    writeRegisterBits(GYRO_REGISTER_CTRL_REG1, 2, 0, 0x03);
   }
 }
 
+#ifndef FXAS21002C_NO_CONFIG
+/**************************************************************************/
+/*!
+    @brief  Maps an ODR to the CTRL_REG1 DR bits
+    @param  ODR
+            The output data rate in Hz
+    @return The DR bits, or 0xFF if ODR is not a supported rate
+*/
+/**************************************************************************/
+static uint8_t odrBits(float ODR) {
+  if (ODR == GYRO_ODR_800HZ)
+    return 0b000;
+  if (ODR == GYRO_ODR_400HZ)
+    return 0b001;
+  if (ODR == GYRO_ODR_200HZ)
+    return 0b010;
+  if (ODR == GYRO_ODR_100HZ)
+    return 0b011;
+  if (ODR == GYRO_ODR_50HZ)
+    return 0b100;
+  if (ODR == GYRO_ODR_25HZ)
+    return 0b101;
+  if (ODR == GYRO_ODR_12_5HZ)
+    return 0b110;
+  return 0xFF;
+}
+
+/** Sample period in us for each CTRL_REG1 DR value */
+static const uint32_t odr_period_us[] = {1250,  2500,  5000, 10000,
+                                         20000, 40000, 80000};
+
 /**************************************************************************/
 /*!
     @brief  Configures the device with certain output data rate(ODR)
@@ -291,27 +595,14 @@ void Adafruit_FXAS21002C::standby(boolean standby) {
 */
 /**************************************************************************/
 void Adafruit_FXAS21002C::setODR(float ODR) {
-  Adafruit_BusIO_Register CTRL_REG1(i2c_dev, GYRO_REGISTER_CTRL_REG1);
-  Adafruit_BusIO_RegisterBits datarate_bits(&CTRL_REG1, 3, 2);
-
   /* CTRL_REG1 should only be set in Standby or Ready mode. First enter Standby
    * mode */
   standby(true);
   /* _ODR is only updated if the input ODR is one of the valid ODRs */
-  if (ODR == GYRO_ODR_800HZ) {
-    datarate_bits.write(0b000);
-  } else if (ODR == GYRO_ODR_400HZ) {
-    datarate_bits.write(0b001);
-  } else if (ODR == GYRO_ODR_200HZ) {
-    datarate_bits.write(0b010);
-  } else if (ODR == GYRO_ODR_100HZ) {
-    datarate_bits.write(0b011);
-  } else if (ODR == GYRO_ODR_50HZ) {
-    datarate_bits.write(0b100);
-  } else if (ODR == GYRO_ODR_25HZ) {
-    datarate_bits.write(0b101);
-  } else if (ODR == GYRO_ODR_12_5HZ) {
-    datarate_bits.write(0b110);
+  uint8_t bits = odrBits(ODR);
+  if (bits != 0xFF) {
+    writeRegisterBits(GYRO_REGISTER_CTRL_REG1, 3, 2, bits);
+    _period = odr_period_us[bits];
   }
   // update internal _ODR variable. Note that this update happens regardless of
   // the validity of ODR
@@ -319,6 +610,43 @@ void Adafruit_FXAS21002C::setODR(float ODR) {
   standby(false);
 }
 
+/**************************************************************************/
+/*!
+    @brief  Changes the output data rate at runtime through Ready mode
+            instead of Standby. Ready mode keeps the drive circuit running,
+            so the sensor is back in Active mode with valid data after
+            1/ODR + 5 ms, instead of the 1/ODR + 60 ms start-up and the
+            100 ms wait of setODR(). The call itself does not block and
+            costs one register read and three writes.
+
+            Samples still in the FIFO were taken at the old rate; drain it
+            before switching if their timestamps matter.
+    @param  ODR
+            The new output data rate, one of the GYRO_ODR_* values
+    @return False if ODR is not supported or the bus failed; _ODR is left
+            unchanged then
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::setODRFast(float ODR) {
+  uint8_t bits = odrBits(ODR);
+  uint8_t ctrl;
+  if (bits == 0xFF || !readRegisters(GYRO_REGISTER_CTRL_REG1, &ctrl, 1))
+    return false;
+
+  /* DR may only be changed outside Active mode: drop to Ready with the old
+   * rate, set the new rate while still in Ready, then go Active */
+  uint8_t ready = (ctrl & ~0x1F) | (bits << 2) | 0b01;
+  if (!writeRegister(GYRO_REGISTER_CTRL_REG1, (ctrl & ~0x03) | 0b01) ||
+      !writeRegister(GYRO_REGISTER_CTRL_REG1, ready) ||
+      !writeRegister(GYRO_REGISTER_CTRL_REG1, ready | 0b10))
+    return false;
+
+  _ODR = ODR;
+  _period = odr_period_us[bits];
+  return true;
+}
+#endif
+
 /**************************************************************************/
 /*!
     @brief  Obtain the current output data rate(ODR) from the gyroscope's
@@ -327,3 +655,361 @@ void Adafruit_FXAS21002C::setODR(float ODR) {
 */
 /**************************************************************************/
 float Adafruit_FXAS21002C::getODR() { return _ODR; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the sample period of the current output data rate, kept
+            as an integer so FXAS21002C_NO_FLOAT builds need no float math
+            to time samples
+    @return The sample period in microseconds
+*/
+/**************************************************************************/
+uint32_t Adafruit_FXAS21002C::getPeriodUs() { return _period; }
+
+#if !defined(FXAS21002C_NO_CONFIG) && !defined(FXAS21002C_NO_FLOAT)
+/**************************************************************************/
+/*!
+    @brief  Enables the on-chip rate threshold interrupt, which fires when
+            the angular rate on any selected axis exceeds the threshold for
+            'count' consecutive samples.
+    @param  axes
+            Bitmask of gyroAxis_t values selecting the axes to monitor
+    @param  dps
+            Threshold in degrees per second. This is encoded for the current
+            full scale range, so call setRange() first.
+    @param  count
+            Debounce count, in ODR periods, the rate must stay above the
+            threshold before the event is raised
+    @param  latch
+            If true, the event stays latched in RT_SRC until it is read with
+            getRateThresholdEvent()
+    @param  pin
+            The interrupt pin the rate threshold event is routed to
+    @return True if the threshold could be encoded for the current range,
+            otherwise false.
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::enableRateThreshold(uint8_t axes, float dps,
+                                              uint8_t count, bool latch,
+                                              gyroIntPin_t pin) {
+  /* Threshold (dps) = (THS + 1) * 256 * sensitivity, see the RT_THS
+   * description in the datasheet. THS is 7 bits wide. */
+  float step = 256.0F * sensitivity();
+  if ((dps < step) || (dps > 128.0F * step) || ((axes & GYRO_AXIS_ALL) == 0))
+    return false;
+  uint8_t ths = (uint8_t)(dps / step + 0.5F) - 1;
+  if (ths > 0x7F)
+    ths = 0x7F;
+
+  /* CTRL_REG2 may only be changed in Standby or Ready mode */
+  standby(true);
+
+  /* DBCNTM = 1: clear the debounce counter when the rate drops below the
+   * threshold, rather than decrementing it */
+  writeRegister(GYRO_REGISTER_RT_THS, 0x80 | ths);
+  writeRegister(GYRO_REGISTER_RT_COUNT, count);
+  writeRegister(GYRO_REGISTER_RT_CFG,
+                (latch ? 0x08 : 0x00) | (axes & GYRO_AXIS_ALL));
+  /* INT_CFG_RT = 1 routes to INT1, INT_EN_RT enables the interrupt */
+  writeRegisterBits(GYRO_REGISTER_CTRL_REG2, 2, 4,
+                    pin == GYRO_INT_PIN_1 ? 0b11 : 0b01);
+
+  standby(false);
+
+  return true;
+}
+#endif
+
+#ifndef FXAS21002C_NO_CONFIG
+/**************************************************************************/
+/*!
+    @brief  Disables rate threshold detection and its interrupt.
+*/
+/**************************************************************************/
+void Adafruit_FXAS21002C::disableRateThreshold() {
+  standby(true);
+  writeRegister(GYRO_REGISTER_RT_CFG, 0x00);
+  writeRegisterBits(GYRO_REGISTER_CTRL_REG2, 2, 4, 0b00);
+  standby(false);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Turns the built-in self-test (CTRL_REG1 ST bit) on or off. While
+            it is on the output is offset by the self-test deflection. The
+            device stays active, so sampling continues.
+    @param  enable
+            True to start the self-test
+    @return True if the register update succeeded
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::setSelfTest(bool enable) {
+  return writeRegisterBits(GYRO_REGISTER_CTRL_REG1, 1, 5, enable);
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Reads and decodes the rate threshold source register. Reading
+            RT_SRC clears a latched event.
+    @return The decoded rate threshold event flags
+*/
+/**************************************************************************/
+gyroRateThresholdEvent_t Adafruit_FXAS21002C::getRateThresholdEvent() {
+  uint8_t src = 0;
+  readRegisters(GYRO_REGISTER_RT_SRC, &src, 1);
+
+  gyroRateThresholdEvent_t event;
+  event.active = src & 0x40;
+  event.z = src & 0x20;
+  event.zNegative = src & 0x10;
+  event.y = src & 0x08;
+  event.yNegative = src & 0x04;
+  event.x = src & 0x02;
+  event.xNegative = src & 0x01;
+
+  return event;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Configures the on-chip FIFO
+    @param  mode
+            The FIFO operating mode, GYRO_FIFO_DISABLED turns it off
+    @param  watermark
+            Number of samples (1-32) that sets the watermark flag, 0 to
+            disable the watermark
+*/
+/**************************************************************************/
+void Adafruit_FXAS21002C::setFIFOMode(gyroFIFOMode_t mode, uint8_t watermark) {
+  if (watermark > FXAS21002C_FIFO_DEPTH)
+    watermark = FXAS21002C_FIFO_DEPTH;
+
+  standby(true);
+
+  /* WRAPTOONE: burst reads wrap from OUT_Z_LSB back to OUT_X_MSB instead of
+   * STATUS, so a single read can drain many samples */
+  writeRegisterBits(GYRO_REGISTER_CTRL_REG3, 1, 3, mode != GYRO_FIFO_DISABLED);
+
+  /* The FIFO has to be disabled before switching between modes */
+  writeRegister(GYRO_REGISTER_F_SETUP, 0x00);
+  if (mode != GYRO_FIFO_DISABLED)
+    writeRegister(GYRO_REGISTER_F_SETUP,
+                  ((uint8_t)mode << 6) | (watermark & 0x3F));
+  _fifoOverflow = false;
+
+  standby(false);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of samples waiting in the FIFO
+    @return The FIFO sample count (0-32)
+*/
+/**************************************************************************/
+uint8_t Adafruit_FXAS21002C::getFIFOCount() {
+  uint8_t status = 0;
+  readRegisters(GYRO_REGISTER_F_STATUS, &status, 1);
+
+  _fifoOverflow = status & 0x80;
+  return status & 0x3F;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Drains the FIFO straight into the caller's buffer. The samples
+            are transferred into 'buffer' in a single burst and byte swapped
+            in place, so no intermediate copy is made.
+    @param[out] buffer
+                Destination for the samples. It only needs the natural
+                2 byte alignment of gyroRawData_t, any gyroRawData_t array
+                qualifies.
+    @param  maxSamples
+            Capacity of 'buffer' in samples; at most FXAS21002C_FIFO_DEPTH
+            samples are ever read
+    @return The number of samples read, 0 if the FIFO was empty or the bus
+            transaction failed
+*/
+/**************************************************************************/
+uint8_t Adafruit_FXAS21002C::readFIFO(gyroRawData_t *buffer,
+                                      uint8_t maxSamples) {
+  uint8_t count = getFIFOCount();
+  if (count > maxSamples)
+    count = maxSamples;
+  if (count == 0)
+    return 0;
+
+  uint8_t *bytes = (uint8_t *)buffer;
+  if (!readRegisters(GYRO_REGISTER_OUT_X_MSB, bytes,
+                     count * sizeof(gyroRawData_t)))
+    return 0;
+
+  /* Big endian register pairs to native int16_t, in place */
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t *p = bytes + i * sizeof(gyroRawData_t);
+    int16_t x = (int16_t)((p[0] << 8) | p[1]);
+    int16_t y = (int16_t)((p[2] << 8) | p[3]);
+    int16_t z = (int16_t)((p[4] << 8) | p[5]);
+    buffer[i].x = x;
+    buffer[i].y = y;
+    buffer[i].z = z;
+  }
+
+  return count;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks the FIFO overflow flag seen by the last getFIFOCount() or
+            readFIFO() call
+    @return True if samples were lost (circular mode) or sampling stopped
+            (stop mode) because the FIFO was full
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::getFIFOOverflow() { return _fifoOverflow; }
+
+/**************************************************************************/
+/*!
+    @brief  Routes the FIFO interrupt to an INT pin. With a watermark set
+            through setFIFOMode() the pin asserts (active low, push-pull)
+            once the FIFO holds that many samples, so the MCU can sleep
+            until then. Reading the FIFO status, e.g. via readFIFO(),
+            clears it.
+    @param  pin
+            The interrupt pin
+    @return True if the register update succeeded
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::enableFIFOInterrupt(gyroIntPin_t pin) {
+  standby(true);
+  /* INT_CFG_FIFO = 1 routes to INT1, INT_EN_FIFO enables the interrupt */
+  bool ok = writeRegisterBits(GYRO_REGISTER_CTRL_REG2, 2, 6,
+                              pin == GYRO_INT_PIN_1 ? 0b11 : 0b01);
+  standby(false);
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Disables the FIFO interrupt
+*/
+/**************************************************************************/
+void Adafruit_FXAS21002C::disableFIFOInterrupt() {
+  standby(true);
+  writeRegisterBits(GYRO_REGISTER_CTRL_REG2, 2, 6, 0b00);
+  standby(false);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Computes how long the MCU may sleep before the FIFO overflows,
+            from the current FIFO fill level and the ODR
+    @param  margin
+            Samples of headroom to keep for wake-up and drain latency
+    @return The sleep time in microseconds, 0 if the FIFO should be drained
+            now
+*/
+/**************************************************************************/
+uint32_t Adafruit_FXAS21002C::getSafeSleepUs(uint8_t margin) {
+  uint8_t count = getFIFOCount();
+  if (_fifoOverflow || (count + margin >= FXAS21002C_FIFO_DEPTH))
+    return 0;
+
+  return (FXAS21002C_FIFO_DEPTH - count - margin) * _period;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets how getEvent(), readRaw() and readSample() handle a failed
+            bus transaction. FIFO reads are never retried, as a failed
+            burst may already have consumed samples.
+    @param  maxRetries
+            Extra attempts after the first one, 0 to fail at once
+    @param  backoffUs
+            Delay before the first retry in microseconds, doubled for each
+            further retry; 0 retries immediately
+*/
+/**************************************************************************/
+void Adafruit_FXAS21002C::setRetryPolicy(uint8_t maxRetries,
+                                         uint16_t backoffUs) {
+  _maxRetries = maxRetries;
+  _backoffUs = backoffUs;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Selects what getEvent() reports when a read fails. It returns
+            false either way.
+    @param  hold
+            True to repeat the last good sample (see isStale()), false to
+            report zero rates
+*/
+/**************************************************************************/
+void Adafruit_FXAS21002C::setHoldLastGood(bool hold) { _holdLastGood = hold; }
+
+/**************************************************************************/
+/*!
+    @brief  Checks whether the last getEvent(), readRaw() or readSample()
+            failed, i.e. whether the data it reported is a held or zeroed
+            value rather than a new sample
+    @return True if the last sample read failed
+*/
+/**************************************************************************/
+bool Adafruit_FXAS21002C::isStale() { return _stale; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the failed sample read statistics
+    @return The counters since construction or the last resetErrorStats()
+*/
+/**************************************************************************/
+const gyroErrorStats_t *Adafruit_FXAS21002C::getErrorStats() {
+  return &_errors;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clears the failed sample read statistics
+*/
+/**************************************************************************/
+void Adafruit_FXAS21002C::resetErrorStats() {
+  memset(&_errors, 0, sizeof(_errors));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Attaches a bus trace. A recording trace logs every register
+            transaction; a replaying one answers them instead of the bus.
+            Attach a replay before begin() so the trace also covers the
+            device check and reset.
+    @param  trace
+            The trace, or NULL to detach
+*/
+/**************************************************************************/
+void Adafruit_FXAS21002C::setTrace(FXAS21002C_Trace *trace) { _trace = trace; }
+
+#ifdef FXAS21002C_BUS_STATS
+/**************************************************************************/
+/*!
+    @brief  Gets the latency histogram of one bus operation type, counted
+            since construction or the last resetBusHistograms()
+    @param  op
+            The operation type
+    @return The histogram, or NULL if 'op' is out of range
+*/
+/**************************************************************************/
+const gyroBusHistogram_t *Adafruit_FXAS21002C::getBusHistogram(gyroBusOp_t op) {
+  if (op >= GYRO_BUS_OP_COUNT)
+    return NULL;
+  return &_busStats[op];
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clears all bus latency histograms
+*/
+/**************************************************************************/
+void Adafruit_FXAS21002C::resetBusHistograms() {
+  memset(_busStats, 0, sizeof(_busStats));
+}
+#endif
@@ -20,11 +20,45 @@
 #ifndef __FXAS21002C_H__
 #define __FXAS21002C_H__
 
+/*=========================================================================
+    BUILD OPTIONS
+    -----------------------------------------------------------------------
+    Define these globally (compiler -D flags) to leave subsystems out of
+    minimal builds:
+
+    FXAS21002C_NO_FLOAT           getEvent() and float sample conversion;
+                                  only the ODR setters take a float
+    FXAS21002C_NO_UNIFIED_SENSOR  Adafruit_Sensor base class and getSensor()
+    FXAS21002C_NO_CONFIG          setRange(), setODR() and rate threshold
+                                  setup, the part stays at 250dps/100Hz
+
+    and this one to add instrumentation:
+
+    FXAS21002C_BUS_STATS          per operation bus latency histograms,
+                                  see getBusHistogram()
+    -----------------------------------------------------------------------*/
+#if defined(FXAS21002C_NO_FLOAT) && !defined(FXAS21002C_NO_UNIFIED_SENSOR)
+/** The unified sensor interface reports floats */
+#define FXAS21002C_NO_UNIFIED_SENSOR
+#endif
+/*=========================================================================*/
+
+#ifdef ARDUINO
 #include <Adafruit_BusIO_Register.h>
 #include <Adafruit_I2CDevice.h>
-#include <Adafruit_Sensor.h>
 #include <Arduino.h>
 #include <Wire.h>
+#else
+#include "FXAS21002C_Host.h"
+#endif
+#ifndef FXAS21002C_NO_FLOAT
+#include <Adafruit_Sensor.h>
+#endif
+
+#include "FXAS21002C_Types.h"
+
+class FXAS21002C_Trace;
+class FXAS21002C_Transport;
 
 /*=========================================================================
     I2C ADDRESS/BITS AND SETTINGS
@@ -68,14 +102,31 @@ typedef enum {
   GYRO_REGISTER_OUT_Y_LSB = 0x04, /**< 0x04 */
   GYRO_REGISTER_OUT_Z_MSB = 0x05, /**< 0x05 */
   GYRO_REGISTER_OUT_Z_LSB = 0x06, /**< 0x06 */
+  GYRO_REGISTER_DR_STATUS = 0x07, /**< 0x07 */
+  GYRO_REGISTER_F_STATUS = 0x08,  /**< 0x08 */
+  GYRO_REGISTER_F_SETUP =
+      0x09, /**< 0x09 (default value = 0b00000000, read/write) */
+  GYRO_REGISTER_F_EVENT = 0x0A,      /**< 0x0A */
+  GYRO_REGISTER_INT_SRC_FLAG = 0x0B, /**< 0x0B */
   GYRO_REGISTER_WHO_AM_I =
       0x0C, /**< 0x0C (default value = 0b11010111, read only) */
   GYRO_REGISTER_CTRL_REG0 =
       0x0D, /**< 0x0D (default value = 0b00000000, read/write) */
+  GYRO_REGISTER_RT_CFG =
+      0x0E, /**< 0x0E (default value = 0b00000000, read/write) */
+  GYRO_REGISTER_RT_SRC =
+      0x0F, /**< 0x0F (default value = 0b00000000, read only) */
+  GYRO_REGISTER_RT_THS =
+      0x10, /**< 0x10 (default value = 0b00000000, read/write) */
+  GYRO_REGISTER_RT_COUNT =
+      0x11, /**< 0x11 (default value = 0b00000000, read/write) */
+  GYRO_REGISTER_TEMP = 0x12, /**< 0x12 */
   GYRO_REGISTER_CTRL_REG1 =
       0x13, /**< 0x13 (default value = 0b00000000, read/write) */
   GYRO_REGISTER_CTRL_REG2 =
       0x14, /**< 0x14 (default value = 0b00000000, read/write) */
+  GYRO_REGISTER_CTRL_REG3 =
+      0x15, /**< 0x15 (default value = 0b00000000, read/write) */
 } gyroRegisters_t;
 /*=========================================================================*/
 
@@ -94,16 +145,100 @@ typedef enum {
 /*=========================================================================*/
 
 /*=========================================================================
-    RAW GYROSCOPE DATA TYPE
+    FIFO SETTINGS
+    -----------------------------------------------------------------------*/
+/** Number of X/Y/Z samples the FIFO holds */
+#define FXAS21002C_FIFO_DEPTH (32)
+
+/*!
+    Enum to define valid FIFO operating modes (F_SETUP F_MODE bits)
+*/
+typedef enum {
+  GYRO_FIFO_DISABLED = 0b00, /**< FIFO disabled */
+  GYRO_FIFO_CIRCULAR = 0b01, /**< Oldest samples are discarded when full */
+  GYRO_FIFO_STOP = 0b10      /**< Sampling into the FIFO stops when full */
+} gyroFIFOMode_t;
+/*=========================================================================*/
+
+/*=========================================================================
+    RATE THRESHOLD SETTINGS
+    -----------------------------------------------------------------------*/
+/*!
+    Axis flags used to select which axes take part in rate threshold
+    detection (bit positions match RT_CFG)
+*/
+typedef enum {
+  GYRO_AXIS_X = 0x01,  /**< X axis */
+  GYRO_AXIS_Y = 0x02,  /**< Y axis */
+  GYRO_AXIS_Z = 0x04,  /**< Z axis */
+  GYRO_AXIS_ALL = 0x07 /**< X, Y and Z axes */
+} gyroAxis_t;
+
+/*!
+    Enum to select which interrupt pin an interrupt source is routed to
+*/
+typedef enum {
+  GYRO_INT_PIN_1, /**< INT1 */
+  GYRO_INT_PIN_2  /**< INT2 */
+} gyroIntPin_t;
+
+/*!
+    Struct to store a decoded RT_SRC (rate threshold source) register
+*/
+typedef struct gyroRateThresholdEvent_s {
+  bool active;    /**< One or more axes crossed the threshold */
+  bool x;         /**< X axis crossed the threshold */
+  bool y;         /**< Y axis crossed the threshold */
+  bool z;         /**< Z axis crossed the threshold */
+  bool xNegative; /**< X axis event polarity (true = negative rate) */
+  bool yNegative; /**< Y axis event polarity (true = negative rate) */
+  bool zNegative; /**< Z axis event polarity (true = negative rate) */
+} gyroRateThresholdEvent_t;
+/*=========================================================================*/
+
+/*=========================================================================
+    READ ERROR HANDLING
     -----------------------------------------------------------------------*/
 /*!
-    Struct to store a single raw (integer-based) gyroscope vector
+    Struct to store failed sample read statistics, see setRetryPolicy()
 */
-typedef struct gyroRawData_s {
-  int16_t x; /**< Raw int16_t value for the x axis */
-  int16_t y; /**< Raw int16_t value for the y axis */
-  int16_t z; /**< Raw int16_t value for the z axis */
-} gyroRawData_t;
+typedef struct gyroErrorStats_s {
+  uint32_t failures;  /**< Failed read attempts, including retried ones */
+  uint32_t retries;   /**< Retry attempts made */
+  uint32_t recovered; /**< Reads that succeeded after one or more retries */
+  uint32_t dropped;   /**< Reads that failed after all retries */
+  uint32_t failedUs;  /**< Time spent in failed attempts and backoff, us */
+} gyroErrorStats_t;
+/*=========================================================================*/
+
+/*=========================================================================
+    BUS STATISTICS (FXAS21002C_BUS_STATS)
+    -----------------------------------------------------------------------*/
+/** Number of log2 latency buckets; bucket 0 counts transactions under
+ * 1us, bucket n those from 2^(n-1) to 2^n - 1 us, the last one the rest */
+#define FXAS21002C_BUS_BUCKETS (16)
+
+/*!
+    Enum to define the bus operation types that are timed separately
+*/
+typedef enum {
+  GYRO_BUS_DATA_READ, /**< STATUS/OUT_* reads of one sample (getEvent()) */
+  GYRO_BUS_FIFO_READ, /**< OUT_* bursts longer than one sample */
+  GYRO_BUS_REG_READ,  /**< Any other register read, incl. read-modify-write */
+  GYRO_BUS_REG_WRITE, /**< Register writes (setRange(), setODR(), ...) */
+  GYRO_BUS_OP_COUNT   /**< Number of operation types */
+} gyroBusOp_t;
+
+/*!
+    Struct to store the latency histogram of one operation type
+*/
+typedef struct gyroBusHistogram_s {
+  uint32_t count;   /**< Number of transactions */
+  uint32_t failed;  /**< Transactions the bus reported as failed */
+  uint32_t totalUs; /**< Sum of all latencies in us, wraps */
+  uint32_t maxUs;   /**< Longest latency in us */
+  uint32_t buckets[FXAS21002C_BUS_BUCKETS]; /**< log2 latency buckets */
+} gyroBusHistogram_t;
 /*=========================================================================*/
 
 /**************************************************************************/
@@ -111,29 +246,117 @@ typedef struct gyroRawData_s {
     @brief  Unified sensor driver for the Adafruit FXAS21002C breakout.
 */
 /**************************************************************************/
+#ifndef FXAS21002C_NO_UNIFIED_SENSOR
 class Adafruit_FXAS21002C : public Adafruit_Sensor {
+#else
+class Adafruit_FXAS21002C {
+#endif
 public:
   Adafruit_FXAS21002C(int32_t sensorID = -1);
   ~Adafruit_FXAS21002C();
+#ifndef FXAS21002C_HOST
   bool begin(uint8_t addr = 0x21, TwoWire *wire = &Wire);
+  bool begin(Adafruit_I2CDevice &i2c);
+#endif
+  bool begin(FXAS21002C_Transport &bus);
+#ifndef FXAS21002C_NO_FLOAT
   bool getEvent(sensors_event_t *event);
+#endif
+  bool readRaw(gyroRawData_t *data);
+  bool readSample(gyroSample_t *sample);
+#ifndef FXAS21002C_NO_UNIFIED_SENSOR
   void getSensor(sensor_t *sensor);
+#endif
   void standby(boolean standby);
 
+#ifndef FXAS21002C_NO_CONFIG
   void setRange(gyroRange_t range);
   void setODR(float ODR);
+  bool setODRFast(float ODR);
+#endif
   gyroRange_t getRange();
   float getODR();
+  uint32_t getPeriodUs();
+#ifndef FXAS21002C_NO_FLOAT
+  float sensitivity();
+#endif
+
+#if !defined(FXAS21002C_NO_CONFIG) && !defined(FXAS21002C_NO_FLOAT)
+  bool enableRateThreshold(uint8_t axes, float dps, uint8_t count,
+                           bool latch = true,
+                           gyroIntPin_t pin = GYRO_INT_PIN_1);
+#endif
+#ifndef FXAS21002C_NO_CONFIG
+  void disableRateThreshold();
+  bool setSelfTest(bool enable);
+#endif
+  gyroRateThresholdEvent_t getRateThresholdEvent();
+
+  void setFIFOMode(gyroFIFOMode_t mode, uint8_t watermark = 0);
+  uint8_t getFIFOCount();
+  uint8_t readFIFO(gyroRawData_t *buffer, uint8_t maxSamples);
+  bool getFIFOOverflow();
+  bool enableFIFOInterrupt(gyroIntPin_t pin = GYRO_INT_PIN_1);
+  void disableFIFOInterrupt();
+  uint32_t getSafeSleepUs(uint8_t margin = 1);
+
+  void setRetryPolicy(uint8_t maxRetries, uint16_t backoffUs = 0);
+  void setHoldLastGood(bool hold);
+  bool isStale();
+  const gyroErrorStats_t *getErrorStats();
+  void resetErrorStats();
+
+  void setTrace(FXAS21002C_Trace *trace);
+
+#ifdef FXAS21002C_BUS_STATS
+  const gyroBusHistogram_t *getBusHistogram(gyroBusOp_t op);
+  void resetBusHistograms();
+#endif
+
   gyroRawData_t raw; ///< Raw gyroscope values from last sensor read
 
+#ifndef FXAS21002C_HOST
 protected:
   Adafruit_I2CDevice *i2c_dev = NULL; ///< Pointer to I2C bus interface
+#endif
 
 private:
+  bool beginDevice();
+  void releaseDevice();
   bool initialize();
+  bool readRegisters(uint8_t reg, uint8_t *buffer, size_t len);
+  bool writeRegister(uint8_t reg, uint8_t value);
+  bool writeRegisterBits(uint8_t reg, uint8_t bits, uint8_t shift,
+                         uint8_t value);
+  bool readData(uint8_t reg, uint8_t *buffer, size_t len);
+#ifdef FXAS21002C_BUS_STATS
+  void recordBusTime(gyroBusOp_t op, uint32_t us, bool ok);
+  gyroBusHistogram_t _busStats[GYRO_BUS_OP_COUNT];
+#endif
   gyroRange_t _range;
   float _ODR;
+  uint32_t _period; ///< Sample period in us, kept with _ODR
   int32_t _sensorID;
+  bool _fifoOverflow = false;
+
+  uint8_t _maxRetries = 0;       ///< Extra attempts per sample read
+  uint16_t _backoffUs = 0;       ///< First retry delay, doubles per retry
+  bool _holdLastGood = false;    ///< getEvent() repeats 'raw' on failure
+  bool _stale = false;           ///< The last sample read failed
+  gyroErrorStats_t _errors = {}; ///< Failed sample read statistics
+
+  /** Bus trace recorder or replay source */
+  FXAS21002C_Trace *_trace = NULL;
+  /** Used instead of i2c_dev if set */
+  FXAS21002C_Transport *_transport = NULL;
+
+#ifndef FXAS21002C_HOST
+  /** In-object storage for the I2C device created by begin(addr, wire), so
+   * the driver never allocates from the heap */
+  alignas(Adafruit_I2CDevice) uint8_t
+      _i2c_dev_storage[sizeof(Adafruit_I2CDevice)];
+  bool _i2c_dev_owned = false; ///< i2c_dev lives in _i2c_dev_storage
+#endif
 };
 
 #endif
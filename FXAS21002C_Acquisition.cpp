@@ -0,0 +1,206 @@
+/*!
+ * @file FXAS21002C_Acquisition.cpp
+ *
+ * Acquisition mode with bus traffic confined to one context and samples
+ * published through a lock-free ring.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Acquisition.h"
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a new FXAS21002C_Acquisition class
+    @param  sensor
+            A sensor that has already been started with begin()
+    @param  buffer
+            Storage for queued samples, owned by the caller
+    @param  capacity
+            Number of samples in 'buffer', see FXAS21002C_SampleRing
+*/
+/**************************************************************************/
+FXAS21002C_Acquisition::FXAS21002C_Acquisition(Adafruit_FXAS21002C &sensor,
+                                               gyroSample_t *buffer,
+                                               fxas_ring_index_t capacity)
+    : _ring(buffer, capacity) {
+  _sensor = &sensor;
+  _period = 0;
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Captures the sensor's range and ODR and puts its FIFO into
+            circular mode. Call this once after configuring the sensor and
+            before poll() or begin(); do not change the sensor's settings
+            while acquisition runs.
+*/
+/**************************************************************************/
+void FXAS21002C_Acquisition::start() {
+  _period = _sensor->getPeriodUs();
+#ifndef FXAS21002C_NO_FLOAT
+  _scale = _sensor->sensitivity() * SENSORS_DPS_TO_RADS;
+#endif
+#ifndef FXAS21002C_NO_UNIFIED_SENSOR
+  _sensor->getSensor(&_info);
+#endif
+  _sensor->setFIFOMode(GYRO_FIFO_CIRCULAR);
+}
+
+#ifdef FXAS21002C_ACQUISITION_TASK
+/**************************************************************************/
+/*!
+    @brief  Calls start() and runs poll() from a dedicated FreeRTOS task
+    @param  core
+            The core the task is pinned to (ESP32 only, ignored elsewhere)
+    @param  stackSize
+            Task stack size, in bytes on ESP32 and words elsewhere
+    @param  priority
+            Task priority
+    @return True if the task was created
+*/
+/**************************************************************************/
+bool FXAS21002C_Acquisition::begin(int core, uint32_t stackSize,
+                                   uint8_t priority) {
+  start();
+#if defined(ESP32)
+  return xTaskCreatePinnedToCore(task, "fxas21002c", stackSize, this,
+                                 priority, NULL, core) == pdPASS;
+#else
+  (void)core;
+  return xTaskCreate(task, "fxas21002c", stackSize, this, priority, NULL) ==
+         pdPASS;
+#endif
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Drains the FIFO and queues the samples. Runs in the acquisition
+            context only: the FreeRTOS task, or loop1() on RP2040. Call it
+            at least every FXAS21002C_FIFO_DEPTH sample periods.
+    @return The number of samples drained
+*/
+/**************************************************************************/
+uint8_t FXAS21002C_Acquisition::poll() {
+  uint8_t n = _sensor->readFIFO(_scratch, FXAS21002C_FIFO_DEPTH);
+  uint32_t now = micros();
+
+  /* The newest sample was taken around 'now', older ones one period apart */
+  gyroSample_t sample;
+  for (uint8_t i = 0; i < n; i++) {
+    sample.timestamp = now - (n - 1 - i) * _period;
+    sample.data = _scratch[i];
+    _ring.push(sample);
+  }
+
+  return n;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the oldest queued sample. Application side only.
+    @param[out] sample
+                The timestamped raw sample
+    @return True if a sample was available
+*/
+/**************************************************************************/
+bool FXAS21002C_Acquisition::read(gyroSample_t *sample) {
+  return _ring.pop(sample);
+}
+
+#ifndef FXAS21002C_NO_FLOAT
+/**************************************************************************/
+/*!
+    @brief  Gets the oldest queued sample as a sensor event, without
+            touching the bus. Application side only.
+    @param[out] event
+                The event, in rad/s. The timestamp is in milliseconds like
+                Adafruit_FXAS21002C::getEvent().
+    @return True if a sample was available
+*/
+/**************************************************************************/
+bool FXAS21002C_Acquisition::getEvent(sensors_event_t *event) {
+  gyroSample_t sample;
+  if (!_ring.pop(&sample))
+    return false;
+
+  memset(event, 0, sizeof(sensors_event_t));
+  event->version = sizeof(sensors_event_t);
+#ifndef FXAS21002C_NO_UNIFIED_SENSOR
+  event->sensor_id = _info.sensor_id;
+#endif
+  event->type = SENSOR_TYPE_GYROSCOPE;
+  event->timestamp = sample.timestamp / 1000;
+  event->gyro.x = sample.data.x * _scale;
+  event->gyro.y = sample.data.y * _scale;
+  event->gyro.z = sample.data.z * _scale;
+
+  return true;
+}
+#endif
+
+#ifndef FXAS21002C_NO_UNIFIED_SENSOR
+/**************************************************************************/
+/*!
+    @brief  Gets the sensor_t data captured by start()
+    @param[out] sensor
+                A reference to the sensor_t instances where the
+                gyroscope sensor info should be written.
+*/
+/**************************************************************************/
+void FXAS21002C_Acquisition::getSensor(sensor_t *sensor) { *sensor = _info; }
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of queued samples
+    @return The number of samples ready to read
+*/
+/**************************************************************************/
+fxas_ring_index_t FXAS21002C_Acquisition::available() {
+  return _ring.available();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of samples dropped because the application did
+            not keep up
+    @return The overrun count
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_Acquisition::overruns() { return _ring.overruns(); }
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+#ifdef FXAS21002C_ACQUISITION_TASK
+/**************************************************************************/
+/*!
+    @brief  Task body: polls whenever the FIFO should be about half full
+    @param  arg
+            The FXAS21002C_Acquisition instance
+*/
+/**************************************************************************/
+void FXAS21002C_Acquisition::task(void *arg) {
+  FXAS21002C_Acquisition *self = (FXAS21002C_Acquisition *)arg;
+  TickType_t interval =
+      pdMS_TO_TICKS(self->_period * (FXAS21002C_FIFO_DEPTH / 2) / 1000);
+  if (interval == 0)
+    interval = 1;
+
+  for (;;) {
+    self->poll();
+    vTaskDelay(interval);
+  }
+}
+#endif
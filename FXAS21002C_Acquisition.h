@@ -0,0 +1,81 @@
+/*!
+ * @file FXAS21002C_Acquisition.h
+ *
+ * Acquisition mode where one context (a FreeRTOS task pinned to a core on
+ * ESP32, or core1's loop1() on RP2040) owns all bus traffic and publishes
+ * timestamped samples through a lock-free ring to the application.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_ACQUISITION_H__
+#define __FXAS21002C_ACQUISITION_H__
+
+#include "Adafruit_FXAS21002C.h"
+#include "FXAS21002C_SampleRing.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+/** A FreeRTOS task can be started with begin() */
+#define FXAS21002C_ACQUISITION_TASK
+#elif defined(FXAS21002C_FREERTOS)
+/* Any other FreeRTOS port, e.g. the POSIX port on Linux */
+#include "FreeRTOS.h"
+#include "task.h"
+/** A FreeRTOS task can be started with begin() */
+#define FXAS21002C_ACQUISITION_TASK
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Decouples bus access from the application. poll() drains the
+            sensor's FIFO and pushes timestamped samples into a ring; it
+            must be the only code touching the sensor or its bus. The
+            application side pops samples with read() or getEvent(), which
+            never touch the bus.
+*/
+/**************************************************************************/
+#ifndef FXAS21002C_NO_UNIFIED_SENSOR
+class FXAS21002C_Acquisition : public Adafruit_Sensor {
+#else
+class FXAS21002C_Acquisition {
+#endif
+public:
+  FXAS21002C_Acquisition(Adafruit_FXAS21002C &sensor, gyroSample_t *buffer,
+                         fxas_ring_index_t capacity);
+
+  void start();
+#ifdef FXAS21002C_ACQUISITION_TASK
+  bool begin(int core = 1, uint32_t stackSize = 4096, uint8_t priority = 5);
+#endif
+  uint8_t poll();
+
+  bool read(gyroSample_t *sample);
+#ifndef FXAS21002C_NO_FLOAT
+  bool getEvent(sensors_event_t *event);
+#endif
+#ifndef FXAS21002C_NO_UNIFIED_SENSOR
+  void getSensor(sensor_t *sensor);
+#endif
+  fxas_ring_index_t available();
+  uint32_t overruns();
+
+private:
+#ifdef FXAS21002C_ACQUISITION_TASK
+  static void task(void *arg);
+#endif
+
+  Adafruit_FXAS21002C *_sensor;
+  FXAS21002C_SampleRing _ring;
+  gyroRawData_t _scratch[FXAS21002C_FIFO_DEPTH];
+  uint32_t _period; ///< Sample period in us, for per sample timestamps
+#ifndef FXAS21002C_NO_FLOAT
+  float _scale; ///< LSB to rad/s, captured in start()
+#endif
+#ifndef FXAS21002C_NO_UNIFIED_SENSOR
+  sensor_t _info; ///< getSensor() data, captured in start()
+#endif
+};
+
+#endif
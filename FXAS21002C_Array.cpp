@@ -0,0 +1,260 @@
+/*!
+ * @file FXAS21002C_Array.cpp
+ *
+ * Manager that drains the FIFOs of several FXAS21002C sensors in
+ * round-robin bursts.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Array.h"
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a new FXAS21002C_Array class
+    @param  callback
+            Called with every burst of samples drained from a sensor
+    @param  muxSelect
+            Called to switch multiplexer channels, may be NULL if no sensor
+            sits behind a multiplexer. It is called with FXAS21002C_NO_MUX
+            when sensors on the main bus are visited, so all channels can
+            be disconnected.
+*/
+/**************************************************************************/
+FXAS21002C_Array::FXAS21002C_Array(fxas_array_callback_t callback,
+                                   fxas_mux_select_t muxSelect) {
+  _callback = callback;
+  _muxSelect = muxSelect;
+  _count = 0;
+  _minSamples = 1;
+  _selectedMux = FXAS21002C_NO_MUX;
+  _selectedChannel = 0;
+  resetStats();
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Adds a sensor that has already been started with begin()
+    @param  sensor
+            The sensor driver
+    @param  mux
+            Id of the multiplexer the sensor sits behind, passed back to the
+            mux select callback, or FXAS21002C_NO_MUX
+    @param  channel
+            The multiplexer channel
+    @return The index of the sensor, or -1 if the array is full
+*/
+/**************************************************************************/
+int8_t FXAS21002C_Array::add(Adafruit_FXAS21002C &sensor, uint8_t mux,
+                             uint8_t channel) {
+  if (_count >= FXAS21002C_ARRAY_MAX)
+    return -1;
+
+  fxasArrayEntry_t *entry = &_entries[_count];
+  entry->sensor = &sensor;
+  entry->mux = mux;
+  entry->channel = channel;
+  entry->period = 0;
+  entry->lastDrain = 0;
+  entry->lastTimestamp = 0;
+
+  /* Keep the visit order sorted by mux and channel, so a round switches
+   * each channel at most once */
+  uint8_t pos = _count;
+  while (pos > 0) {
+    const fxasArrayEntry_t *prev = &_entries[_order[pos - 1]];
+    if ((prev->mux < mux) || ((prev->mux == mux) && (prev->channel <= channel)))
+      break;
+    _order[pos] = _order[pos - 1];
+    pos--;
+  }
+  _order[pos] = _count;
+
+  return _count++;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Puts every sensor's FIFO into circular mode and starts the
+            schedule. Call again after changing a sensor's ODR.
+    @param  minSamples
+            A sensor is only drained once its FIFO is expected to hold at
+            least this many samples, larger values mean fewer, longer bursts
+*/
+/**************************************************************************/
+void FXAS21002C_Array::begin(uint8_t minSamples) {
+  if (minSamples == 0)
+    minSamples = 1;
+  if (minSamples > FXAS21002C_FIFO_DEPTH)
+    minSamples = FXAS21002C_FIFO_DEPTH;
+  _minSamples = minSamples;
+
+  for (uint8_t k = 0; k < _count; k++) {
+    fxasArrayEntry_t *entry = &_entries[_order[k]];
+    select(entry);
+    entry->sensor->setFIFOMode(GYRO_FIFO_CIRCULAR);
+    entry->period = entry->sensor->getPeriodUs();
+    entry->lastDrain = micros();
+    entry->lastTimestamp = 0;
+  }
+
+  resetStats();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Runs one scheduling round: visits the sensors in mux order and
+            drains every FIFO that is expected to have reached the
+            threshold. Call this from loop() as often as possible.
+    @return The number of samples delivered during this round
+*/
+/**************************************************************************/
+uint16_t FXAS21002C_Array::poll() {
+  uint16_t delivered = 0;
+
+  for (uint8_t k = 0; k < _count; k++) {
+    uint8_t index = _order[k];
+    fxasArrayEntry_t *entry = &_entries[index];
+    uint32_t now = micros();
+
+    /* Predict the FIFO level from the time since the last drain rather
+     * than spending a bus transaction on F_STATUS */
+    if ((entry->period == 0) ||
+        ((now - entry->lastDrain) / entry->period < _minSamples))
+      continue;
+
+    select(entry);
+    delivered += drain(index, now);
+  }
+
+  return delivered;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of sensors
+    @return The number of sensors added
+*/
+/**************************************************************************/
+uint8_t FXAS21002C_Array::count() { return _count; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the timestamp of the newest sample delivered for a sensor
+    @param  index
+            The sensor index returned by add()
+    @return The timestamp in microseconds, 0 before the first drain
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_Array::getLastTimestamp(uint8_t index) {
+  return (index < _count) ? _entries[index].lastTimestamp : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the aggregate counters since begin() or resetStats()
+    @return The counters
+*/
+/**************************************************************************/
+fxasArrayStats_t FXAS21002C_Array::getStats() {
+  _stats.elapsed = micros() - _statsStart;
+  return _stats;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the aggregate sample rate delivered across all sensors
+    @return Samples per second since begin() or resetStats()
+*/
+/**************************************************************************/
+float FXAS21002C_Array::getThroughput() {
+  fxasArrayStats_t stats = getStats();
+  if (stats.elapsed == 0)
+    return 0;
+  return stats.samples * 1000000.0F / stats.elapsed;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clears the aggregate counters
+*/
+/**************************************************************************/
+void FXAS21002C_Array::resetStats() {
+  memset(&_stats, 0, sizeof(_stats));
+  _statsStart = micros();
+}
+
+/***************************************************************************
+ PROTECTED FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Routes the bus to a sensor, switching the mux only on change
+    @param  entry
+            The sensor to route to
+*/
+/**************************************************************************/
+void FXAS21002C_Array::select(const fxasArrayEntry_t *entry) {
+  if (!_muxSelect || ((entry->mux == _selectedMux) &&
+                      ((entry->mux == FXAS21002C_NO_MUX) ||
+                       (entry->channel == _selectedChannel))))
+    return;
+
+  _muxSelect(entry->mux, entry->channel);
+  _selectedMux = entry->mux;
+  _selectedChannel = entry->channel;
+  _stats.muxSwitch++;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Drains one sensor's FIFO and hands the burst to the callback
+    @param  index
+            The sensor index
+    @param  now
+            micros() when the drain was scheduled
+    @return The number of samples delivered
+*/
+/**************************************************************************/
+uint8_t FXAS21002C_Array::drain(uint8_t index, uint32_t now) {
+  fxasArrayEntry_t *entry = &_entries[index];
+
+  uint8_t n = entry->sensor->readFIFO(_scratch, FXAS21002C_FIFO_DEPTH);
+  entry->lastDrain = now;
+
+  /* F_STATUS read plus the burst, each with a register address write */
+  _stats.busBytes += 2 + (n ? 1 + n * sizeof(gyroRawData_t) : 0);
+  if (entry->sensor->getFIFOOverflow())
+    _stats.overflows++;
+  if (n == 0)
+    return 0;
+
+  /* The newest sample was taken around 'now'. Continue the previous
+   * timeline while it agrees to within half a period to suppress drain
+   * jitter, otherwise (first drain, overflow, drift) restart from 'now'. */
+  uint32_t first = now - (n - 1) * entry->period;
+  uint32_t expected = entry->lastTimestamp + entry->period;
+  int32_t error = (int32_t)(first - expected);
+  if (entry->lastTimestamp && !entry->sensor->getFIFOOverflow() &&
+      (error < (int32_t)(entry->period / 2)) &&
+      (error > -(int32_t)(entry->period / 2)))
+    first = expected;
+  entry->lastTimestamp = first + (n - 1) * entry->period;
+
+  _stats.samples += n;
+  _stats.drains++;
+
+  if (_callback)
+    _callback(index, _scratch, n, first, entry->period);
+
+  return n;
+}
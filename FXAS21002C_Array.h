@@ -0,0 +1,102 @@
+/*!
+ * @file FXAS21002C_Array.h
+ *
+ * Manager that drains the FIFOs of several FXAS21002C sensors, on one or
+ * more buses and behind I2C multiplexers, in round-robin bursts.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_ARRAY_H__
+#define __FXAS21002C_ARRAY_H__
+
+#include "Adafruit_FXAS21002C.h"
+
+#ifndef FXAS21002C_ARRAY_MAX
+/** Maximum number of sensors one manager schedules */
+#define FXAS21002C_ARRAY_MAX (8)
+#endif
+
+/** Mux id for sensors that are not behind a multiplexer */
+#define FXAS21002C_NO_MUX (0xFF)
+
+/** Callback that routes the bus to a multiplexer channel. It must also
+ * disconnect channels of other multiplexers that could clash. */
+typedef void (*fxas_mux_select_t)(uint8_t mux, uint8_t channel);
+
+/** Callback receiving each drained burst: sensor index (in add() order),
+ * samples oldest first, sample count, timestamp of the first sample in
+ * microseconds, and sample period in microseconds */
+typedef void (*fxas_array_callback_t)(uint8_t index,
+                                      const gyroRawData_t *samples,
+                                      uint8_t count, uint32_t timestamp,
+                                      uint32_t period);
+
+/*!
+    Struct to store the aggregate throughput of an FXAS21002C_Array
+*/
+typedef struct fxasArrayStats_s {
+  uint32_t samples;   /**< Samples delivered */
+  uint32_t busBytes;  /**< Bytes moved on the bus, incl. register writes */
+  uint32_t drains;    /**< FIFO drains that returned data */
+  uint32_t muxSwitch; /**< Multiplexer channel changes */
+  uint32_t overflows; /**< Drains that found the FIFO overflowed */
+  uint32_t elapsed;   /**< Microseconds covered by these counters */
+} fxasArrayStats_t;
+
+/**************************************************************************/
+/*!
+    @brief  Round-robin FIFO drain scheduler for multiple FXAS21002C
+            sensors. Sensors are visited grouped by multiplexer channel so
+            the mux is switched as rarely as possible, and a sensor's bus is
+            only touched once its FIFO is expected to hold enough samples.
+*/
+/**************************************************************************/
+class FXAS21002C_Array {
+public:
+  FXAS21002C_Array(fxas_array_callback_t callback,
+                   fxas_mux_select_t muxSelect = NULL);
+
+  int8_t add(Adafruit_FXAS21002C &sensor, uint8_t mux = FXAS21002C_NO_MUX,
+             uint8_t channel = 0);
+  void begin(uint8_t minSamples = FXAS21002C_FIFO_DEPTH / 2);
+  uint16_t poll();
+
+  uint8_t count();
+  uint32_t getLastTimestamp(uint8_t index);
+  fxasArrayStats_t getStats();
+  float getThroughput();
+  void resetStats();
+
+protected:
+  /*!
+      Per sensor scheduling state
+  */
+  typedef struct {
+    Adafruit_FXAS21002C *sensor; /**< The sensor driver */
+    uint8_t mux;                 /**< Multiplexer id or FXAS21002C_NO_MUX */
+    uint8_t channel;             /**< Multiplexer channel */
+    uint32_t period;             /**< Sample period in microseconds */
+    uint32_t lastDrain;          /**< micros() of the last drain */
+    uint32_t lastTimestamp;      /**< Timestamp of the newest sample */
+  } fxasArrayEntry_t;
+
+  void select(const fxasArrayEntry_t *entry);
+  uint8_t drain(uint8_t index, uint32_t now);
+
+  fxasArrayEntry_t _entries[FXAS21002C_ARRAY_MAX]; ///< Sensors, add() order
+  uint8_t _order[FXAS21002C_ARRAY_MAX];            ///< Visit order
+  uint8_t _count;                                  ///< Number of sensors
+  uint8_t _minSamples;                             ///< Drain threshold
+  gyroRawData_t _scratch[FXAS21002C_FIFO_DEPTH];   ///< Drain buffer
+
+private:
+  fxas_array_callback_t _callback;
+  fxas_mux_select_t _muxSelect;
+  uint8_t _selectedMux;
+  uint8_t _selectedChannel;
+  fxasArrayStats_t _stats;
+  uint32_t _statsStart;
+};
+
+#endif
@@ -0,0 +1,310 @@
+/*!
+ * @file FXAS21002C_ChunkLog.cpp
+ *
+ * Seekable log container for long recordings.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_ChunkLog.h"
+#include <string.h>
+
+/** Magic at the start of every chunk */
+static const uint8_t chunk_magic[4] = {'F', 'X', 'C', 'K'};
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+static void putU16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void putU32(uint8_t *p, uint32_t v) {
+  putU16(p, v & 0xFFFF);
+  putU16(p + 2, v >> 16);
+}
+
+static void putU64(uint8_t *p, uint64_t v) {
+  putU32(p, (uint32_t)v);
+  putU32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t getU16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static uint32_t getU32(const uint8_t *p) {
+  return getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+static uint64_t getU64(const uint8_t *p) {
+  return getU32(p) | ((uint64_t)getU32(p + 4) << 32);
+}
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a new FXAS21002C_ChunkWriter class
+    @param  buffer
+            Storage for one chunk, owned by the caller
+    @param  chunkSize
+            Size of 'buffer' and of every chunk, a multiple of
+            FXAS21002C_CHUNKLOG_SECTOR; only the first
+            FXAS21002C_CHUNKLOG_MAX_SIZE bytes are used of a larger buffer
+    @param  sink
+            Called with every completed chunk
+*/
+/**************************************************************************/
+FXAS21002C_ChunkWriter::FXAS21002C_ChunkWriter(uint8_t *buffer,
+                                               size_t chunkSize,
+                                               fxas_chunk_sink_t sink) {
+  _buffer = buffer;
+  if (chunkSize > FXAS21002C_CHUNKLOG_MAX_SIZE)
+    chunkSize = FXAS21002C_CHUNKLOG_MAX_SIZE;
+  _chunkSize = chunkSize - chunkSize % FXAS21002C_CHUNKLOG_SECTOR;
+  _sink = sink;
+  _last = 0;
+  _started = false;
+  startChunk();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a new FXAS21002C_ChunkReader class
+    @param  log
+            The complete log; it must stay valid while the reader is used
+    @param  len
+            Length of 'log' in bytes
+*/
+/**************************************************************************/
+FXAS21002C_ChunkReader::FXAS21002C_ChunkReader(const uint8_t *log,
+                                               size_t len) {
+  _log = log;
+  _len = len;
+  _chunkSize = 0;
+
+  if ((len >= FXAS21002C_CHUNKLOG_HEADER_SIZE) &&
+      !memcmp(log, chunk_magic, sizeof(chunk_magic))) {
+    size_t size = getU32(log + 4);
+    if (size && !(size % FXAS21002C_CHUNKLOG_SECTOR) &&
+        (size <= FXAS21002C_CHUNKLOG_MAX_SIZE))
+      _chunkSize = size;
+  }
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Adds a burst of samples, e.g. one FIFO drain, starting a new
+            chunk when it does not fit into the current one
+    @param  samples
+            The raw samples, oldest first
+    @param  count
+            Number of samples, 1 to 256
+    @param  timestamp
+            micros() of the first sample; bursts must be added in time
+            order, less than 71 minutes apart
+    @param  period
+            Sample period in microseconds
+    @return False if the sink failed or the burst does not fit into an
+            empty chunk
+*/
+/**************************************************************************/
+bool FXAS21002C_ChunkWriter::add(const gyroRawData_t *samples, uint16_t count,
+                                 uint32_t timestamp, uint32_t period) {
+  if (!_chunkSize || !count)
+    return false;
+
+  /* Extend micros() to 64 bits across wraps */
+  uint64_t time = _started ? _last + (uint32_t)(timestamp - (uint32_t)_last)
+                           : timestamp;
+  _last = time;
+  _started = true;
+
+  uint8_t *payload = _buffer + FXAS21002C_CHUNKLOG_HEADER_SIZE;
+  size_t room = _chunkSize - FXAS21002C_CHUNKLOG_HEADER_SIZE - _pos;
+  size_t n = FXAS21002C_RiceLog::encode(samples, count, timestamp, period,
+                                        payload + _pos, room);
+  if (!n || (_info.samples + count > 0xFFFF)) {
+    if (!_info.samples || !flush())
+      return false;
+    room = _chunkSize - FXAS21002C_CHUNKLOG_HEADER_SIZE;
+    n = FXAS21002C_RiceLog::encode(samples, count, timestamp, period, payload,
+                                   room);
+    if (!n)
+      return false;
+  }
+
+  if (!_info.samples)
+    _info.start = time;
+  _info.end = time + (uint64_t)(count - 1) * period;
+  _info.samples += count;
+  for (uint16_t i = 0; i < count; i++) {
+    const int16_t v[3] = {samples[i].x, samples[i].y, samples[i].z};
+    for (uint8_t axis = 0; axis < 3; axis++) {
+      if (v[axis] < _info.min[axis])
+        _info.min[axis] = v[axis];
+      if (v[axis] > _info.max[axis])
+        _info.max[axis] = v[axis];
+    }
+  }
+  _pos += n;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Completes the current chunk, pads it and hands it to the sink.
+            Call it before closing the log; calling it more often wastes
+            the padding.
+    @return False if the sink failed
+*/
+/**************************************************************************/
+bool FXAS21002C_ChunkWriter::flush() {
+  if (!_info.samples)
+    return true;
+
+  uint8_t *h = _buffer;
+  memcpy(h, chunk_magic, sizeof(chunk_magic));
+  putU32(h + 4, _chunkSize);
+  putU64(h + 8, _info.start);
+  putU64(h + 16, _info.end);
+  putU16(h + 24, _info.samples);
+  putU16(h + 26, _pos);
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    putU16(h + 28 + 2 * axis, _info.min[axis]);
+    putU16(h + 34 + 2 * axis, _info.max[axis]);
+  }
+  memset(h + FXAS21002C_CHUNKLOG_HEADER_SIZE + _pos, 0,
+         _chunkSize - FXAS21002C_CHUNKLOG_HEADER_SIZE - _pos);
+
+  bool ok = _sink(_buffer, _chunkSize);
+  startChunk();
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of complete chunks in the log
+    @return The chunk count, 0 if the log does not start with a chunk
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_ChunkReader::chunks() {
+  return _chunkSize ? _len / _chunkSize : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes a chunk header
+    @param  index
+            The chunk number
+    @param[out] info
+                The header
+    @return False if the chunk does not exist or its header is invalid
+*/
+/**************************************************************************/
+bool FXAS21002C_ChunkReader::getInfo(uint32_t index, fxasChunkInfo_t *info) {
+  if (index >= chunks())
+    return false;
+
+  const uint8_t *h = _log + (size_t)index * _chunkSize;
+  if (memcmp(h, chunk_magic, sizeof(chunk_magic)) ||
+      (getU32(h + 4) != _chunkSize) ||
+      (getU16(h + 26) > _chunkSize - FXAS21002C_CHUNKLOG_HEADER_SIZE))
+    return false;
+
+  info->start = getU64(h + 8);
+  info->end = getU64(h + 16);
+  info->samples = getU16(h + 24);
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    info->min[axis] = (int16_t)getU16(h + 28 + 2 * axis);
+    info->max[axis] = (int16_t)getU16(h + 34 + 2 * axis);
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Binary-searches the first chunk that ends at or after 'time'
+    @param  time
+            The time in microseconds, on the writer's 64 bit time line
+    @return The chunk number, or chunks() if every chunk ends earlier. An
+            invalid chunk header is treated as ending at the end of time.
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_ChunkReader::find(uint64_t time) {
+  uint32_t lo = 0, hi = chunks();
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    fxasChunkInfo_t info;
+    if (getInfo(mid, &info) && (info.end < time))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes all samples of a chunk
+    @param  index
+            The chunk number
+    @param[out] out
+                Destination for the samples. Their timestamps are the low
+                32 bits of the 64 bit time; the full time of a sample is
+                info.start + (uint32_t)(timestamp - (uint32_t)info.start).
+    @param  maxSamples
+            Capacity of 'out', see fxasChunkInfo_t::samples
+    @return The number of samples, or -1 if the chunk is invalid or 'out'
+            is too small
+*/
+/**************************************************************************/
+int32_t FXAS21002C_ChunkReader::read(uint32_t index, gyroSample_t *out,
+                                     uint16_t maxSamples) {
+  fxasChunkInfo_t info;
+  if (!getInfo(index, &info) || (info.samples > maxSamples))
+    return -1;
+
+  const uint8_t *h = _log + (size_t)index * _chunkSize;
+  const uint8_t *p = h + FXAS21002C_CHUNKLOG_HEADER_SIZE;
+  size_t left = getU16(h + 26);
+  int32_t total = 0;
+  while (left) {
+    size_t used;
+    int16_t n = FXAS21002C_RiceLog::decode(p, left, out + total,
+                                           maxSamples - total, &used);
+    if (n < 0)
+      return -1;
+    total += n;
+    p += used;
+    left -= used;
+  }
+  return total == info.samples ? total : -1;
+}
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Resets the header of the current chunk
+*/
+/**************************************************************************/
+void FXAS21002C_ChunkWriter::startChunk() {
+  _pos = 0;
+  _info.start = 0;
+  _info.end = 0;
+  _info.samples = 0;
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    _info.min[axis] = INT16_MAX;
+    _info.max[axis] = INT16_MIN;
+  }
+}
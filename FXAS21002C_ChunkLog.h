@@ -0,0 +1,109 @@
+/*!
+ * @file FXAS21002C_ChunkLog.h
+ *
+ * Seekable log container for long recordings. The log is a sequence of
+ * fixed size chunks (a multiple of 512 bytes, so chunks line up with SD
+ * card sectors, and at most 64 KiB so the payload length fits its 16 bit
+ * field), each starting with a 40 byte header, little endian:
+ *
+ *   char     magic[4]    "FXCK"
+ *   uint32_t chunkSize   size of every chunk in bytes
+ *   uint64_t start       time of the first sample in microseconds
+ *   uint64_t end         time of the last sample in microseconds
+ *   uint16_t samples     number of samples in the chunk
+ *   uint16_t payload     bytes of FXAS21002C_RiceLog blocks that follow
+ *   int16_t  min[3]      smallest x, y and z value in the chunk
+ *   int16_t  max[3]      largest x, y and z value in the chunk
+ *
+ * followed by the payload and zero padding. Times are 64 bit so they do
+ * not wrap like micros() does after 71 minutes.
+ *
+ * Because every chunk has the same size, the chunk headers form the index:
+ * a reader finds chunk n at n * chunkSize and binary-searches chunks by
+ * time without scanning the log or reading a footer, and a log cut short
+ * by a power loss stays readable up to the last complete chunk.
+ *
+ * Neither side has Arduino dependencies, so the reader builds as-is on a
+ * host, where it works on a memory-mapped log file.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_CHUNKLOG_H__
+#define __FXAS21002C_CHUNKLOG_H__
+
+#include "FXAS21002C_RiceLog.h"
+
+/** Size of a chunk header in bytes */
+#define FXAS21002C_CHUNKLOG_HEADER_SIZE (40)
+/** Chunk sizes must be a multiple of this */
+#define FXAS21002C_CHUNKLOG_SECTOR (512)
+/** Largest chunk size; larger sizes are clamped to it */
+#define FXAS21002C_CHUNKLOG_MAX_SIZE (65536)
+
+/** Callback that stores one complete chunk, e.g. by writing it to a File;
+ * returns true on success */
+typedef bool (*fxas_chunk_sink_t)(const uint8_t *chunk, size_t size);
+
+/*!
+    Struct to store a decoded chunk header
+*/
+typedef struct fxasChunkInfo_s {
+  uint64_t start;   /**< Time of the first sample in microseconds */
+  uint64_t end;     /**< Time of the last sample in microseconds */
+  uint16_t samples; /**< Number of samples */
+  int16_t min[3];   /**< Smallest x, y and z value */
+  int16_t max[3];   /**< Largest x, y and z value */
+} fxasChunkInfo_t;
+
+/**************************************************************************/
+/*!
+    @brief  Packs sample bursts into chunks on the recording side. Bursts
+            are Rice coded (see FXAS21002C_RiceLog) straight into the chunk
+            buffer, and every completed chunk is handed to the sink.
+*/
+/**************************************************************************/
+class FXAS21002C_ChunkWriter {
+public:
+  FXAS21002C_ChunkWriter(uint8_t *buffer, size_t chunkSize,
+                         fxas_chunk_sink_t sink);
+
+  bool add(const gyroRawData_t *samples, uint16_t count, uint32_t timestamp,
+           uint32_t period);
+  bool flush();
+
+private:
+  void startChunk();
+
+  uint8_t *_buffer;
+  size_t _chunkSize;
+  fxas_chunk_sink_t _sink;
+
+  size_t _pos;           ///< Payload bytes in the current chunk
+  fxasChunkInfo_t _info; ///< Header of the current chunk
+  uint64_t _last;        ///< Extended time of the previous burst
+  bool _started;         ///< _last is valid
+};
+
+/**************************************************************************/
+/*!
+    @brief  Finds and decodes chunks in a complete log held in memory, e.g.
+            a log file mapped with mmap()
+*/
+/**************************************************************************/
+class FXAS21002C_ChunkReader {
+public:
+  FXAS21002C_ChunkReader(const uint8_t *log, size_t len);
+
+  uint32_t chunks();
+  bool getInfo(uint32_t index, fxasChunkInfo_t *info);
+  uint32_t find(uint64_t time);
+  int32_t read(uint32_t index, gyroSample_t *out, uint16_t maxSamples);
+
+private:
+  const uint8_t *_log;
+  size_t _len;
+  size_t _chunkSize;
+};
+
+#endif
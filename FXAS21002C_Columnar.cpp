@@ -0,0 +1,284 @@
+/*!
+ * @file FXAS21002C_Columnar.cpp
+ *
+ * Columnar archive format for recorded FXAS21002C data.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Columnar.h"
+#include <string.h>
+
+/** Magic at the start of every chunk */
+static const uint8_t column_magic[4] = {'F', 'X', 'C', 'C'};
+
+/** Offset of the first per-axis entry in the header */
+#define AXIS_ENTRY (24)
+/** Size of a per-axis entry */
+#define AXIS_ENTRY_SIZE (16)
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+static void putU16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void putU32(uint8_t *p, uint32_t v) {
+  putU16(p, v & 0xFFFF);
+  putU16(p + 2, v >> 16);
+}
+
+static void putU64(uint8_t *p, uint64_t v) {
+  putU32(p, (uint32_t)v);
+  putU32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t getU16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static uint32_t getU32(const uint8_t *p) {
+  return getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+static uint64_t getU64(const uint8_t *p) {
+  return getU32(p) | ((uint64_t)getU32(p + 4) << 32);
+}
+
+static int16_t axisValue(const gyroRawData_t &s, uint8_t axis) {
+  return axis == 0 ? s.x : (axis == 1 ? s.y : s.z);
+}
+
+static uint16_t isqrt(uint64_t v) {
+  uint64_t root = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+  while (bit > v)
+    bit >>= 2;
+  while (bit) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint16_t)root;
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Encodes samples as one chunk
+    @param  samples
+            The raw samples, oldest first
+    @param  count
+            Number of samples, at least 1
+    @param  start
+            Time of the first sample in microseconds
+    @param  period
+            Sample period in microseconds
+    @param[out] out
+            Destination buffer, FXAS21002C_COLUMNAR_MAX_CHUNK(count) bytes
+            always suffice
+    @param  outSize
+            Size of 'out' in bytes
+    @return The number of bytes written, 0 if 'count' is 0 or 'out' was too
+            small
+*/
+/**************************************************************************/
+size_t FXAS21002C_Columnar::encode(const gyroRawData_t *samples,
+                                   uint16_t count, uint64_t start,
+                                   uint32_t period, uint8_t *out,
+                                   size_t outSize) {
+  if (!count || (outSize < FXAS21002C_COLUMNAR_HEADER_SIZE))
+    return 0;
+
+  memcpy(out, column_magic, sizeof(column_magic));
+  putU64(out + 8, start);
+  putU32(out + 16, period);
+  putU16(out + 20, count);
+  putU16(out + 22, 0);
+
+  size_t pos = FXAS21002C_COLUMNAR_HEADER_SIZE;
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    int16_t min = INT16_MAX, max = INT16_MIN;
+    int32_t sum = 0;
+    uint64_t squares = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      int16_t v = axisValue(samples[i], axis);
+      if (v < min)
+        min = v;
+      if (v > max)
+        max = v;
+      sum += v;
+      squares += (uint32_t)((int32_t)v * v);
+    }
+
+    size_t n = FXAS21002C_RiceLog::encodeAxis(samples, count, axis,
+                                              out + pos, outSize - pos);
+    if (!n)
+      return 0;
+
+    uint8_t *e = out + AXIS_ENTRY + axis * AXIS_ENTRY_SIZE;
+    putU16(e, min);
+    putU16(e + 2, max);
+    putU16(e + 4, (int16_t)(sum / count));
+    putU16(e + 6, isqrt(squares / count));
+    putU32(e + 8, pos);
+    putU32(e + 12, n);
+    pos += n;
+  }
+
+  putU32(out + 4, pos);
+  return pos;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks the chunk at 'in' and gets its size, to walk a file of
+            chunks
+    @param  in
+            Pointer to the start of a chunk
+    @param  len
+            Number of bytes available at 'in'
+    @return The size of the chunk in bytes, 0 if 'in' does not start with
+            a complete, valid chunk
+*/
+/**************************************************************************/
+size_t FXAS21002C_Columnar::chunkSize(const uint8_t *in, size_t len) {
+  if ((len < FXAS21002C_COLUMNAR_HEADER_SIZE) ||
+      memcmp(in, column_magic, sizeof(column_magic)))
+    return 0;
+
+  size_t size = getU32(in + 4);
+  if ((size < FXAS21002C_COLUMNAR_HEADER_SIZE) || (size > len) ||
+      !getU16(in + 20))
+    return 0;
+
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    const uint8_t *e = in + AXIS_ENTRY + axis * AXIS_ENTRY_SIZE;
+    uint32_t offset = getU32(e + 8), length = getU32(e + 12);
+    if ((offset < FXAS21002C_COLUMNAR_HEADER_SIZE) || (offset > size) ||
+        (length > size - offset))
+      return 0;
+  }
+  return size;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the time base of a chunk
+    @param  in
+            Pointer to the start of a chunk
+    @param  len
+            Number of bytes available at 'in'
+    @param[out] info
+                The start time, period and sample count
+    @return False if 'in' is not a valid chunk
+*/
+/**************************************************************************/
+bool FXAS21002C_Columnar::getInfo(const uint8_t *in, size_t len,
+                                  fxasColumnInfo_t *info) {
+  if (!chunkSize(in, len))
+    return false;
+  info->start = getU64(in + 8);
+  info->period = getU32(in + 16);
+  info->count = getU16(in + 20);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the statistics of one axis from the chunk header
+    @param  in
+            Pointer to the start of a chunk
+    @param  len
+            Number of bytes available at 'in'
+    @param  axis
+            0 for x, 1 for y, 2 for z
+    @param[out] stats
+                The statistics
+    @return False if 'in' is not a valid chunk
+*/
+/**************************************************************************/
+bool FXAS21002C_Columnar::getStats(const uint8_t *in, size_t len,
+                                   uint8_t axis, fxasColumnStats_t *stats) {
+  if ((axis > 2) || !chunkSize(in, len))
+    return false;
+
+  const uint8_t *e = in + AXIS_ENTRY + axis * AXIS_ENTRY_SIZE;
+  stats->min = (int16_t)getU16(e);
+  stats->max = (int16_t)getU16(e + 2);
+  stats->mean = (int16_t)getU16(e + 4);
+  stats->rms = getU16(e + 6);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Skip test for magnitude queries such as "rate above 300 dps",
+            using only the chunk header
+    @param  in
+            Pointer to the start of a chunk
+    @param  len
+            Number of bytes available at 'in'
+    @param  axes
+            Axes to check: bit 0 x, bit 1 y, bit 2 z, as in gyroAxis_t
+    @param  magnitude
+            The threshold in LSB
+    @return False if no sample of the selected axes can exceed
+            'magnitude' in either direction, so the chunk can be skipped;
+            also false for an invalid chunk
+*/
+/**************************************************************************/
+bool FXAS21002C_Columnar::mayExceed(const uint8_t *in, size_t len,
+                                    uint8_t axes, int16_t magnitude) {
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    fxasColumnStats_t stats;
+    if (!(axes & (1 << axis)) || !getStats(in, len, axis, &stats))
+      continue;
+    if ((stats.max > magnitude) || (stats.min < -(int32_t)magnitude))
+      return true;
+  }
+  return false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes one column, touching only that column's bytes
+    @param  in
+            Pointer to the start of a chunk
+    @param  len
+            Number of bytes available at 'in'
+    @param  axis
+            0 for x, 1 for y, 2 for z
+    @param[out] out
+                Receives the values in the selected axis; the other axes
+                are left untouched
+    @param  maxSamples
+            Capacity of 'out'
+    @return The number of samples, or -1 if the chunk is invalid or 'out'
+            is too small
+*/
+/**************************************************************************/
+int32_t FXAS21002C_Columnar::readAxis(const uint8_t *in, size_t len,
+                                      uint8_t axis, gyroRawData_t *out,
+                                      uint16_t maxSamples) {
+  if ((axis > 2) || !chunkSize(in, len))
+    return -1;
+
+  uint16_t count = getU16(in + 20);
+  if (count > maxSamples)
+    return -1;
+
+  const uint8_t *e = in + AXIS_ENTRY + axis * AXIS_ENTRY_SIZE;
+  if (!FXAS21002C_RiceLog::decodeAxis(in + getU32(e + 8), getU32(e + 12), out,
+                                      count, axis))
+    return -1;
+  return count;
+}
@@ -0,0 +1,88 @@
+/*!
+ * @file FXAS21002C_Columnar.h
+ *
+ * Columnar archive format for recorded FXAS21002C data, meant for
+ * analytics over large collections of logs. Each chunk stores x, y and z
+ * as separately compressed columns (see FXAS21002C_RiceLog::encodeAxis())
+ * and per-axis statistics, so a scan reads only the chunk headers and the
+ * columns it needs. Timestamps are not stored per sample: sample n was
+ * taken at start + n * period.
+ *
+ * Each chunk starts with a 72 byte header, little endian:
+ *
+ *   char     magic[4]    "FXCC"
+ *   uint32_t size        size of the whole chunk in bytes
+ *   uint64_t start       time of the first sample in microseconds
+ *   uint32_t period      sample period in microseconds
+ *   uint16_t count       number of samples
+ *   uint16_t reserved    0
+ *
+ * followed by one 16 byte entry each for x, y and z:
+ *
+ *   int16_t  min, max    smallest and largest value
+ *   int16_t  mean        mean value, rounded toward zero
+ *   uint16_t rms         root mean square value
+ *   uint32_t offset      position of the column from the chunk start
+ *   uint32_t length      size of the column in bytes
+ *
+ * and the three columns. Chunks are independent, so a host converter can
+ * decode a log with the matching decoder (DeltaLog, RiceLog, ChunkLog) and
+ * encode chunks on as many threads as it likes, as
+ * extras/convert/fxas21002c_convert.cpp does. Neither side has Arduino
+ * dependencies.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_COLUMNAR_H__
+#define __FXAS21002C_COLUMNAR_H__
+
+#include "FXAS21002C_RiceLog.h"
+
+/** Size of a chunk header in bytes */
+#define FXAS21002C_COLUMNAR_HEADER_SIZE (72)
+/** Worst case size of a chunk holding 'n' samples */
+#define FXAS21002C_COLUMNAR_MAX_CHUNK(n)                                       \
+  (FXAS21002C_COLUMNAR_HEADER_SIZE + 3 * FXAS21002C_RICELOG_MAX_AXIS(n))
+
+/*!
+    Struct to store the statistics of one axis of a chunk
+*/
+typedef struct fxasColumnStats_s {
+  int16_t min;  /**< Smallest value */
+  int16_t max;  /**< Largest value */
+  int16_t mean; /**< Mean value */
+  uint16_t rms; /**< Root mean square value */
+} fxasColumnStats_t;
+
+/*!
+    Struct to store the time base of a chunk
+*/
+typedef struct fxasColumnInfo_s {
+  uint64_t start;  /**< Time of the first sample in microseconds */
+  uint32_t period; /**< Sample period in microseconds */
+  uint16_t count;  /**< Number of samples */
+} fxasColumnInfo_t;
+
+/**************************************************************************/
+/*!
+    @brief  Encoder, statistics and column readers for columnar chunks
+*/
+/**************************************************************************/
+class FXAS21002C_Columnar {
+public:
+  static size_t encode(const gyroRawData_t *samples, uint16_t count,
+                       uint64_t start, uint32_t period, uint8_t *out,
+                       size_t outSize);
+
+  static size_t chunkSize(const uint8_t *in, size_t len);
+  static bool getInfo(const uint8_t *in, size_t len, fxasColumnInfo_t *info);
+  static bool getStats(const uint8_t *in, size_t len, uint8_t axis,
+                       fxasColumnStats_t *stats);
+  static bool mayExceed(const uint8_t *in, size_t len, uint8_t axes,
+                        int16_t magnitude);
+  static int32_t readAxis(const uint8_t *in, size_t len, uint8_t axis,
+                          gyroRawData_t *out, uint16_t maxSamples);
+};
+
+#endif
@@ -0,0 +1,161 @@
+/*!
+ * @file FXAS21002C_DeltaLog.cpp
+ *
+ * Compact delta encoded record format for logging raw FXAS21002C samples.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_DeltaLog.h"
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+static void putU16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void putU32(uint8_t *p, uint32_t v) {
+  putU16(p, v & 0xFFFF);
+  putU16(p + 2, v >> 16);
+}
+
+static uint16_t getU16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static uint32_t getU32(const uint8_t *p) {
+  return getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+/* Zigzag maps small signed deltas to small unsigned values, then LEB128
+ * stores 7 bits per byte. A 17 bit delta never needs more than 3 bytes. */
+static uint8_t putVarint(uint8_t *p, int32_t delta) {
+  uint32_t v = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+  uint8_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (v & 0x7F) | 0x80;
+    v >>= 7;
+  }
+  p[n++] = v;
+  return n;
+}
+
+static uint8_t getVarint(const uint8_t *p, size_t len, int32_t *delta) {
+  uint32_t v = 0;
+  for (uint8_t n = 0; (n < len) && (n < 3); n++) {
+    v |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+    if (!(p[n] & 0x80)) {
+      *delta = (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+      return n + 1;
+    }
+  }
+  return 0;
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Encodes a burst of samples, e.g. one FIFO drain, as one block
+    @param  samples
+            The raw samples, oldest first
+    @param  count
+            Number of samples, 1 to 256
+    @param  timestamp
+            Time of the first sample in microseconds
+    @param  period
+            Sample period in microseconds
+    @param[out] out
+            Destination buffer, FXAS21002C_DELTALOG_MAX_BLOCK(count) bytes
+            always suffice
+    @param  outSize
+            Size of 'out' in bytes
+    @return The number of bytes written, 0 if 'count' is out of range or
+            'out' was too small
+*/
+/**************************************************************************/
+size_t FXAS21002C_DeltaLog::encode(const gyroRawData_t *samples,
+                                   uint16_t count, uint32_t timestamp,
+                                   uint32_t period, uint8_t *out,
+                                   size_t outSize) {
+  if ((count == 0) || (count > 256) ||
+      (outSize < FXAS21002C_DELTALOG_KEYFRAME_SIZE))
+    return 0;
+
+  out[0] = FXAS21002C_DELTALOG_MARKER;
+  out[1] = count - 1;
+  putU32(out + 2, timestamp);
+  putU32(out + 6, period);
+  putU16(out + 10, samples[0].x);
+  putU16(out + 12, samples[0].y);
+  putU16(out + 14, samples[0].z);
+
+  size_t pos = FXAS21002C_DELTALOG_KEYFRAME_SIZE;
+  for (uint16_t i = 1; i < count; i++) {
+    if (outSize - pos < FXAS21002C_DELTALOG_DELTA_MAX)
+      return 0;
+    pos += putVarint(out + pos, (int32_t)samples[i].x - samples[i - 1].x);
+    pos += putVarint(out + pos, (int32_t)samples[i].y - samples[i - 1].y);
+    pos += putVarint(out + pos, (int32_t)samples[i].z - samples[i - 1].z);
+  }
+
+  return pos;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes one block
+    @param  in
+            Pointer to the start of a block
+    @param  len
+            Number of bytes available at 'in'
+    @param[out] out
+            Destination for the decoded samples
+    @param  maxSamples
+            Capacity of 'out'; up to 256 samples may be needed
+    @param[out] used
+            If not NULL, receives the size of the block in bytes
+    @return The number of samples decoded, or -1 if 'in' does not start
+            with a complete block or 'out' is too small
+*/
+/**************************************************************************/
+int16_t FXAS21002C_DeltaLog::decode(const uint8_t *in, size_t len,
+                                    gyroSample_t *out, uint16_t maxSamples,
+                                    size_t *used) {
+  if ((len < FXAS21002C_DELTALOG_KEYFRAME_SIZE) ||
+      (in[0] != FXAS21002C_DELTALOG_MARKER))
+    return -1;
+
+  uint16_t count = in[1] + 1;
+  if (count > maxSamples)
+    return -1;
+
+  uint32_t timestamp = getU32(in + 2);
+  uint32_t period = getU32(in + 6);
+  out[0].timestamp = timestamp;
+  out[0].data.x = (int16_t)getU16(in + 10);
+  out[0].data.y = (int16_t)getU16(in + 12);
+  out[0].data.z = (int16_t)getU16(in + 14);
+
+  size_t pos = FXAS21002C_DELTALOG_KEYFRAME_SIZE;
+  for (uint16_t i = 1; i < count; i++) {
+    int32_t d[3];
+    for (uint8_t axis = 0; axis < 3; axis++) {
+      uint8_t n = getVarint(in + pos, len - pos, &d[axis]);
+      if (n == 0)
+        return -1;
+      pos += n;
+    }
+    out[i].timestamp = timestamp + i * period;
+    out[i].data.x = (int16_t)(out[i - 1].data.x + d[0]);
+    out[i].data.y = (int16_t)(out[i - 1].data.y + d[1]);
+    out[i].data.z = (int16_t)(out[i - 1].data.z + d[2]);
+  }
+
+  if (used)
+    *used = pos;
+  return count;
+}
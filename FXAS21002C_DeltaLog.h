@@ -0,0 +1,54 @@
+/*!
+ * @file FXAS21002C_DeltaLog.h
+ *
+ * Compact delta encoded record format for logging raw FXAS21002C samples.
+ *
+ * Each block starts with a 16 byte keyframe, little endian:
+ *
+ *   uint8_t  marker      'K' (0x4B)
+ *   uint8_t  deltas      number of delta records that follow
+ *   uint32_t timestamp   time of the keyframe sample in microseconds
+ *   uint32_t period      sample period in microseconds (1 / ODR)
+ *   int16_t  x, y, z     absolute raw values of the keyframe sample
+ *
+ * followed by 'deltas' records of three zigzag LEB128 varints holding the
+ * difference of x, y and z to the previous sample. Sample n of the block was
+ * taken at timestamp + n * period. Blocks are self contained, so a reader
+ * can resynchronise on any keyframe.
+ *
+ * Neither side has Arduino dependencies, so the decoder builds as-is on a
+ * host.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_DELTALOG_H__
+#define __FXAS21002C_DELTALOG_H__
+
+#include "FXAS21002C_Types.h"
+
+/** Keyframe marker byte */
+#define FXAS21002C_DELTALOG_MARKER (0x4B)
+/** Size of a keyframe in bytes */
+#define FXAS21002C_DELTALOG_KEYFRAME_SIZE (16)
+/** Worst case size of one delta record (three 3 byte varints) */
+#define FXAS21002C_DELTALOG_DELTA_MAX (9)
+/** Worst case size of a block holding 'n' samples */
+#define FXAS21002C_DELTALOG_MAX_BLOCK(n)                                       \
+  (FXAS21002C_DELTALOG_KEYFRAME_SIZE + ((n)-1) * FXAS21002C_DELTALOG_DELTA_MAX)
+
+/**************************************************************************/
+/*!
+    @brief  Encoder and decoder for delta encoded sample blocks
+*/
+/**************************************************************************/
+class FXAS21002C_DeltaLog {
+public:
+  static size_t encode(const gyroRawData_t *samples, uint16_t count,
+                       uint32_t timestamp, uint32_t period, uint8_t *out,
+                       size_t outSize);
+  static int16_t decode(const uint8_t *in, size_t len, gyroSample_t *out,
+                        uint16_t maxSamples, size_t *used = NULL);
+};
+
+#endif
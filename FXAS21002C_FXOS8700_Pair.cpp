@@ -0,0 +1,121 @@
+/*!
+ * @file FXAS21002C_FXOS8700_Pair.cpp
+ *
+ * Paired FXAS21002C + FXOS8700 acquisition for 9-DoF boards.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_FXOS8700_Pair.h"
+#include <new>
+
+#ifndef FXAS21002C_HOST
+
+/** FXOS8700 STATUS register, start of the hybrid burst */
+#define FXOS8700_REGISTER_STATUS (0x00)
+/** FXOS8700 WHO_AM_I register */
+#define FXOS8700_REGISTER_WHO_AM_I (0x0D)
+/** FXOS8700 device ID */
+#define FXOS8700_ID (0xC7)
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a new FXAS21002C_FXOS8700_Pair class
+    @param  gyro
+            A gyroscope that has already been started with begin()
+*/
+/**************************************************************************/
+FXAS21002C_FXOS8700_Pair::FXAS21002C_FXOS8700_Pair(Adafruit_FXAS21002C &gyro) {
+  _gyro = &gyro;
+}
+
+/***************************************************************************
+ DESTRUCTOR
+ ***************************************************************************/
+
+FXAS21002C_FXOS8700_Pair::~FXAS21002C_FXOS8700_Pair() {
+  if (_fxos)
+    _fxos->~Adafruit_I2CDevice();
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Attaches to the FXOS8700 and puts the gyroscope FIFO into
+            circular mode
+    @param  addr
+            The I2C address of the FXOS8700
+    @param  wire
+            Pointer to Wire instance the FXOS8700 is on
+    @return True if the FXOS8700 was found, otherwise false
+*/
+/**************************************************************************/
+bool FXAS21002C_FXOS8700_Pair::begin(uint8_t addr, TwoWire *wire) {
+  if (_fxos)
+    _fxos->~Adafruit_I2CDevice();
+  _fxos = new (_fxos_storage) Adafruit_I2CDevice(addr, wire);
+  if (!_fxos->begin())
+    return false;
+
+  Adafruit_BusIO_Register WHO_AM_I(_fxos, FXOS8700_REGISTER_WHO_AM_I);
+  if (WHO_AM_I.read() != FXOS8700_ID)
+    return false;
+
+  _gyro->setFIFOMode(GYRO_FIFO_CIRCULAR);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Drains the gyroscope FIFO and reads the latest FXOS8700 sample
+            in back-to-back transactions, stamped with one timestamp
+    @param[out] gyro
+                Gyroscope samples, oldest first
+    @param  maxGyro
+                Capacity of 'gyro'
+    @param[out] fxos
+                The latest FXOS8700 accelerometer and magnetometer reading;
+                'valid' is false if it could not be read, otherwise check
+                ZYXDR in 'status' to see whether it is new
+    @param[out] timestamp
+                micros() between the two reads; it is the time of the
+                newest gyroscope sample and of the FXOS8700 reading
+    @return The number of gyroscope samples. They have left the FIFO and
+            are returned even if the FXOS8700 read failed.
+*/
+/**************************************************************************/
+uint8_t FXAS21002C_FXOS8700_Pair::poll(gyroRawData_t *gyro, uint8_t maxGyro,
+                                       fxosRawData_t *fxos,
+                                       uint32_t *timestamp) {
+  uint8_t n = _gyro->readFIFO(gyro, maxGyro);
+  *timestamp = micros();
+
+  uint8_t buffer[13];
+  buffer[0] = FXOS8700_REGISTER_STATUS;
+  if (!_fxos || !_fxos->write_then_read(buffer, 1, buffer, 13)) {
+    fxos->valid = false;
+    fxos->status = 0;
+    return n;
+  }
+
+  /* Accelerometer data is 14-bit left justified, magnetometer 16-bit */
+  fxos->valid = true;
+  fxos->status = buffer[0];
+  fxos->ax = (int16_t)((buffer[1] << 8) | buffer[2]) >> 2;
+  fxos->ay = (int16_t)((buffer[3] << 8) | buffer[4]) >> 2;
+  fxos->az = (int16_t)((buffer[5] << 8) | buffer[6]) >> 2;
+  fxos->mx = (int16_t)((buffer[7] << 8) | buffer[8]);
+  fxos->my = (int16_t)((buffer[9] << 8) | buffer[10]);
+  fxos->mz = (int16_t)((buffer[11] << 8) | buffer[12]);
+
+  return n;
+}
+
+#endif
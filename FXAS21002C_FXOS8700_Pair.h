@@ -0,0 +1,63 @@
+/*!
+ * @file FXAS21002C_FXOS8700_Pair.h
+ *
+ * Paired acquisition for 9-DoF boards that put the FXAS21002C next to an
+ * FXOS8700 accelerometer/magnetometer on the same bus, such as the Adafruit
+ * Precision NXP 9-DoF breakout.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_FXOS8700_PAIR_H__
+#define __FXAS21002C_FXOS8700_PAIR_H__
+
+#include "Adafruit_FXAS21002C.h"
+
+#ifndef FXAS21002C_HOST
+
+/** Default 7-bit address of the FXOS8700 on the 9-DoF breakout */
+#define FXOS8700_PAIR_ADDRESS (0x1F)
+
+/*!
+    Struct to store one raw FXOS8700 accelerometer + magnetometer reading
+*/
+typedef struct fxosRawData_s {
+  bool valid;     /**< False if the FXOS8700 could not be read */
+  uint8_t status; /**< FXOS8700 STATUS, bit 3 (ZYXDR) set for new data */
+  int16_t ax;     /**< Raw 14-bit accelerometer x axis */
+  int16_t ay;     /**< Raw 14-bit accelerometer y axis */
+  int16_t az;     /**< Raw 14-bit accelerometer z axis */
+  int16_t mx;     /**< Raw 16-bit magnetometer x axis */
+  int16_t my;     /**< Raw 16-bit magnetometer y axis */
+  int16_t mz;     /**< Raw 16-bit magnetometer z axis */
+} fxosRawData_t;
+
+/**************************************************************************/
+/*!
+    @brief  Reads an FXAS21002C and an FXOS8700 back-to-back with a shared
+            timestamp. The FXOS8700 must already be configured in hybrid
+            mode with hyb_autoinc_mode set (as the Adafruit_FXOS8700
+            library does), so a single 13 byte burst from STATUS returns
+            the accelerometer followed by the magnetometer.
+*/
+/**************************************************************************/
+class FXAS21002C_FXOS8700_Pair {
+public:
+  FXAS21002C_FXOS8700_Pair(Adafruit_FXAS21002C &gyro);
+  ~FXAS21002C_FXOS8700_Pair();
+
+  bool begin(uint8_t addr = FXOS8700_PAIR_ADDRESS, TwoWire *wire = &Wire);
+  uint8_t poll(gyroRawData_t *gyro, uint8_t maxGyro, fxosRawData_t *fxos,
+               uint32_t *timestamp);
+
+private:
+  Adafruit_FXAS21002C *_gyro;
+  Adafruit_I2CDevice *_fxos = NULL;
+
+  /** In-object storage for the FXOS8700 bus device */
+  alignas(Adafruit_I2CDevice) uint8_t _fxos_storage[sizeof(Adafruit_I2CDevice)];
+};
+
+#endif
+
+#endif
@@ -0,0 +1,289 @@
+/*!
+ * @file FXAS21002C_Governor.cpp
+ *
+ * Adaptive output data rate for the FXAS21002C.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Governor.h"
+
+#ifndef FXAS21002C_NO_CONFIG
+
+/** Supported rates, slowest first */
+static const float levels[] = {GYRO_ODR_12_5HZ, GYRO_ODR_25HZ,
+                               GYRO_ODR_50HZ,   GYRO_ODR_100HZ,
+                               GYRO_ODR_200HZ,  GYRO_ODR_400HZ,
+                               GYRO_ODR_800HZ};
+
+/** Number of entries in levels */
+#define LEVEL_COUNT (sizeof(levels) / sizeof(levels[0]))
+
+/** Largest deviation from the batch mean taken into the noise estimate,
+ * keeps the squared sum of a full FIFO within 32 bits */
+#define NOISE_DIFF_CLAMP (4095)
+
+/**************************************************************************/
+/*!
+    @brief  Gets one axis of a sample
+    @param  s
+            The sample
+    @param  axis
+            0 for x, 1 for y, 2 for z
+    @return The axis value
+*/
+/**************************************************************************/
+static int16_t axisValue(const gyroRawData_t &s, uint8_t axis) {
+  return axis == 0 ? s.x : (axis == 1 ? s.y : s.z);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Finds the level of an ODR
+    @param  ODR
+            The output data rate in Hz
+    @return The index into levels, LEVEL_COUNT if ODR is not supported
+*/
+/**************************************************************************/
+static uint8_t levelOf(float ODR) {
+  uint8_t i = 0;
+  while (i < LEVEL_COUNT && levels[i] != ODR)
+    i++;
+  return i;
+}
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a new FXAS21002C_Governor class
+    @param  sensor
+            A sensor that has already been started with begin()
+*/
+/**************************************************************************/
+FXAS21002C_Governor::FXAS21002C_Governor(Adafruit_FXAS21002C &sensor) {
+  _sensor = &sensor;
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Puts the FIFO into circular mode and starts at the highest
+            allowed rate
+    @param  minODR
+            The slowest rate the governor may select
+    @param  maxODR
+            The rate used while the sensor moves
+    @return False if a rate is not supported, minODR is above maxODR or the
+            sensor could not be switched
+*/
+/**************************************************************************/
+bool FXAS21002C_Governor::begin(float minODR, float maxODR) {
+  _minLevel = levelOf(minODR);
+  _maxLevel = levelOf(maxODR);
+  if (_maxLevel >= LEVEL_COUNT || _minLevel > _maxLevel)
+    return false;
+
+  _sensor->setFIFOMode(GYRO_FIFO_CIRCULAR);
+  _primed = false;
+  _quiet = false;
+  bool ok = select(_maxLevel);
+  _switches = 0;
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets the motion thresholds, in raw LSB of the current range.
+            Keep each low threshold below its high one; the gap between
+            them is the hysteresis band. The defaults (64/128 LSB mean
+            rate, 16/32 LSB noise) suit the 250 dps range.
+    @param  rateLow
+            Mean rate below which an axis counts as still
+    @param  rateHigh
+            Mean rate above which an axis counts as moving
+    @param  noiseLow
+            Noise (rms) below which an axis counts as still
+    @param  noiseHigh
+            Noise (rms) above which an axis counts as moving, e.g. when
+            vibrating without net rotation
+*/
+/**************************************************************************/
+void FXAS21002C_Governor::setThresholds(uint16_t rateLow, uint16_t rateHigh,
+                                        uint16_t noiseLow,
+                                        uint16_t noiseHigh) {
+  _rateLow = rateLow;
+  _rateHigh = rateHigh;
+  _noiseLow = noiseLow;
+  _noiseHigh = noiseHigh;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets how long the sensor must stay still before each step down
+    @param  ms
+            The hold time in milliseconds, 2000 by default
+*/
+/**************************************************************************/
+void FXAS21002C_Governor::setHoldTime(uint32_t ms) { _hold = ms; }
+
+/**************************************************************************/
+/*!
+    @brief  Drains the FIFO, timestamps the samples and adjusts the ODR.
+            Call it at least every FXAS21002C_FIFO_DEPTH periods of the
+            highest rate, since the governor may switch to it at any poll.
+    @param[out] samples
+                The drained samples, oldest first
+    @param  maxSamples
+                Capacity of 'samples'
+    @return The number of samples
+*/
+/**************************************************************************/
+uint8_t FXAS21002C_Governor::poll(gyroSample_t *samples, uint8_t maxSamples) {
+  if (maxSamples > FXAS21002C_FIFO_DEPTH)
+    maxSamples = FXAS21002C_FIFO_DEPTH;
+  uint8_t n = _sensor->readFIFO(_scratch, maxSamples);
+  if (n == 0)
+    return 0;
+  uint32_t now = micros();
+
+  /* The newest sample was taken around 'now', older ones one period apart.
+   * Right after a switch the backdated times can reach into the previous
+   * batch, which was taken at another rate, so keep them after it. */
+  for (uint8_t i = 0; i < n; i++) {
+    uint32_t t = now - (uint32_t)(n - 1 - i) * _period;
+    if (_primed && (int32_t)(t - (_last + _period)) < 0)
+      t = _last + _period;
+    samples[i].timestamp = t;
+    samples[i].data = _scratch[i];
+    _last = t;
+  }
+
+  bool active;
+  bool still = quiet(n, &active);
+  uint32_t ms = millis();
+  if (active) {
+    _quiet = false;
+    if (_level < _maxLevel)
+      select(_maxLevel);
+  } else if (!still) {
+    _quiet = false;
+  } else if (!_quiet) {
+    _quiet = true;
+    _quietSince = ms;
+  } else if (ms - _quietSince >= _hold && _level > _minLevel) {
+    select(_level - 1);
+    _quietSince = ms;
+  }
+
+  return n;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the rate the governor currently runs the sensor at
+    @return The ODR in Hz
+*/
+/**************************************************************************/
+float FXAS21002C_Governor::getODR() { return levels[_level]; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the sample period of the current rate
+    @return The period in microseconds
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_Governor::getPeriod() { return _period; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of ODR changes since begin()
+    @return The switch count
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_Governor::switches() { return _switches; }
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Classifies the drained batch and tracks the zero-rate offset
+    @param  n
+            Samples in _scratch
+    @param[out] active
+                Set if any axis is above a high threshold
+    @return True if every axis is below both low thresholds. The noise
+            thresholds only apply to batches of at least two samples.
+*/
+/**************************************************************************/
+bool FXAS21002C_Governor::quiet(uint8_t n, bool *active) {
+  bool still = true;
+  *active = false;
+
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    int32_t sum = 0;
+    for (uint8_t i = 0; i < n; i++)
+      sum += axisValue(_scratch[i], axis);
+    int32_t mean = sum / n;
+
+    uint32_t sq = 0;
+    for (uint8_t i = 0; i < n; i++) {
+      int32_t d = axisValue(_scratch[i], axis) - mean;
+      if (d > NOISE_DIFF_CLAMP)
+        d = NOISE_DIFF_CLAMP;
+      else if (d < -NOISE_DIFF_CLAMP)
+        d = -NOISE_DIFF_CLAMP;
+      sq += (uint32_t)(d * d);
+    }
+    uint32_t var = sq / n;
+
+    if (!_primed)
+      _bias[axis] = mean * 16;
+    int32_t rate = mean - _bias[axis] / 16;
+    if (rate < 0)
+      rate = -rate;
+
+    /* A single sample has no spread, only the rate test applies then */
+    bool noisy = (n >= 2) && (var > (uint32_t)_noiseHigh * _noiseHigh);
+    bool calm = (n < 2) || (var < (uint32_t)_noiseLow * _noiseLow);
+
+    /* Follow slow offset drift only while the axis is still; a steady
+     * turn inside the hysteresis band must not be learned as offset */
+    if (rate < _rateLow && calm)
+      _bias[axis] += mean - _bias[axis] / 16;
+
+    if (rate > _rateHigh || noisy)
+      *active = true;
+    if (rate >= _rateLow || !calm)
+      still = false;
+  }
+
+  _primed = true;
+  return still;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Switches the sensor to a level
+    @param  level
+            The index into levels
+    @return True if the sensor accepted the new rate
+*/
+/**************************************************************************/
+bool FXAS21002C_Governor::select(uint8_t level) {
+  if (!_sensor->setODRFast(levels[level]))
+    return false;
+  _level = level;
+  _period = _sensor->getPeriodUs();
+  _switches++;
+  return true;
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*!
+ * @file FXAS21002C_Governor.h
+ *
+ * Adaptive output data rate for the FXAS21002C: samples slowly while the
+ * sensor is at rest and switches to a high rate as soon as it moves.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_GOVERNOR_H__
+#define __FXAS21002C_GOVERNOR_H__
+
+#include "Adafruit_FXAS21002C.h"
+
+#ifndef FXAS21002C_NO_CONFIG
+
+/**************************************************************************/
+/*!
+    @brief  Drains the FIFO and picks the ODR from the drained samples.
+            Each batch is reduced to a per-axis mean rate, relative to a
+            zero-rate offset that is slowly tracked while the axis is
+            below the low thresholds, and a per-axis noise (rms around
+            that mean). Motion above the high thresholds jumps
+            straight to the highest rate; the rate is stepped down one level
+            at a time only after everything stayed below the low thresholds
+            for the hold time. Between the two thresholds nothing changes.
+            Start it with the sensor at rest, the first batch seeds the
+            offset. Motion is noticed with the next sample, so up to one
+            period of the slowest rate allowed after it starts.
+
+            Noise is measured within a batch, so it needs at least two
+            samples per poll(): poll no more often than every two periods
+            of the slowest rate, or only the rate thresholds apply to the
+            single sample batches.
+
+            Switches use setODRFast(), which goes through Ready mode and
+            does not block, and are made right after a drain, so each batch
+            holds samples of a single rate and gets timestamps spaced by the
+            period it was taken at. Timestamps never go backwards across a
+            switch.
+*/
+/**************************************************************************/
+class FXAS21002C_Governor {
+public:
+  FXAS21002C_Governor(Adafruit_FXAS21002C &sensor);
+
+  bool begin(float minODR = GYRO_ODR_12_5HZ, float maxODR = GYRO_ODR_800HZ);
+  void setThresholds(uint16_t rateLow, uint16_t rateHigh, uint16_t noiseLow,
+                     uint16_t noiseHigh);
+  void setHoldTime(uint32_t ms);
+
+  uint8_t poll(gyroSample_t *samples, uint8_t maxSamples);
+
+  float getODR();
+  uint32_t getPeriod();
+  uint32_t switches();
+
+private:
+  bool quiet(uint8_t n, bool *active);
+  bool select(uint8_t level);
+
+  Adafruit_FXAS21002C *_sensor;
+  gyroRawData_t _scratch[FXAS21002C_FIFO_DEPTH];
+
+  uint16_t _rateLow = 64;
+  uint16_t _rateHigh = 128;
+  uint16_t _noiseLow = 16;
+  uint16_t _noiseHigh = 32;
+  uint32_t _hold = 2000;
+
+  uint8_t _minLevel = 0;
+  uint8_t _maxLevel = 0;
+  uint8_t _level = 0;
+  uint32_t _period = 0;      ///< Period of the current ODR in us
+  uint32_t _last = 0;        ///< Timestamp of the newest sample returned
+  uint32_t _quietSince = 0;  ///< millis() when the sensor went quiet
+  bool _quiet = false;       ///< _quietSince is valid
+  bool _primed = false;      ///< _bias and _last are valid
+  int32_t _bias[3];          ///< Zero-rate offset, LSB * 16
+  uint32_t _switches = 0;
+};
+
+#endif
+
+#endif
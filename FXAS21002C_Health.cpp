@@ -0,0 +1,368 @@
+/*!
+ * @file FXAS21002C_Health.cpp
+ *
+ * Sensor health monitor for the FXAS21002C.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Health.h"
+
+/** Largest consecutive difference taken into the noise estimate, keeps the
+ * squared sum of a window within 32 bits */
+#define NOISE_DIFF_CLAMP (4095)
+
+/**************************************************************************/
+/*!
+    @brief  Integer square root
+    @param  v
+            The value
+    @return floor(sqrt(v))
+*/
+/**************************************************************************/
+static uint16_t isqrt(uint32_t v) {
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > v)
+    bit >>= 2;
+  while (bit) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint16_t)root;
+}
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a new FXAS21002C_Health class
+    @param  sensor
+            The sensor whose samples are checked; also used to switch the
+            self-test on and off
+*/
+/**************************************************************************/
+FXAS21002C_Health::FXAS21002C_Health(Adafruit_FXAS21002C &sensor) {
+  _sensor = &sensor;
+  reset();
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Sets how many identical consecutive values mark an axis stuck
+    @param  samples
+            The sample count, 0 disables the check. A live sensor never
+            repeats the exact same value for long, even at rest.
+*/
+/**************************************************************************/
+void FXAS21002C_Health::setStuckLimit(uint16_t samples) {
+  _stuckLimit = samples;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets the expected noise band. Noise is measured over
+            FXAS21002C_HEALTH_NOISE_WINDOW samples and is only meaningful
+            while the sensor is not shaken.
+    @param  minRms
+            Lowest plausible noise in LSB rms, 0 disables the check
+    @param  maxRms
+            Highest plausible noise in LSB rms, 0 disables the check
+*/
+/**************************************************************************/
+void FXAS21002C_Health::setNoiseLimits(uint16_t minRms, uint16_t maxRms) {
+  _minNoise = minRms;
+  _maxNoise = maxRms;
+}
+
+#ifndef FXAS21002C_NO_CONFIG
+/**************************************************************************/
+/*!
+    @brief  Sets how often the self-test runs
+    @param  samples
+            Samples between self-tests, 0 (the default) only runs it on
+            startSelfTest()
+*/
+/**************************************************************************/
+void FXAS21002C_Health::setSelfTestInterval(uint32_t samples) {
+  _stInterval = samples;
+  _stCountdown = samples;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets the accepted self-test deflection. The expected value
+            depends on the range (see the datasheet); the defaults only
+            catch a dead actuator or a saturated output.
+    @param  minLsb
+            Smallest accepted deflection magnitude per axis, in LSB
+    @param  maxLsb
+            Largest accepted deflection magnitude per axis, in LSB
+*/
+/**************************************************************************/
+void FXAS21002C_Health::setSelfTestLimits(int16_t minLsb, int16_t maxLsb) {
+  _stMin = minLsb;
+  _stMax = maxLsb;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets how many samples the sensor can take before addSample()
+            sees them. Samples already taken when the ST bit changes still
+            carry the old state, so both settle phases are extended by
+            this many samples.
+    @param  samples
+            0 (the default) when every sample is read right before
+            addSample(), e.g. with readRaw(). For FIFO drains the largest
+            number of samples passed to addSample() per drain plus those
+            that can queue in the FIFO meanwhile; FXAS21002C_FIFO_DEPTH
+            covers draining the FIFO and checking the burst at once.
+*/
+/**************************************************************************/
+void FXAS21002C_Health::setSelfTestLatency(uint8_t samples) {
+  _stLatency = samples;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts a self-test with the next sample, unless one is running
+*/
+/**************************************************************************/
+void FXAS21002C_Health::startSelfTest() {
+  if (_stState != ST_IDLE)
+    return;
+  _stState = ST_BASELINE;
+  _stCount = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    _stBase[i] = 0;
+    _stSum[i] = 0;
+  }
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Checks one sample. Call it for every sample read from the
+            sensor, in order.
+    @param  sample
+            The raw sample
+    @return False if the sample is offset by a running self-test and
+            should not be used
+*/
+/**************************************************************************/
+bool FXAS21002C_Health::addSample(const gyroRawData_t &sample) {
+  const int16_t v[3] = {sample.x, sample.y, sample.z};
+
+#ifndef FXAS21002C_NO_CONFIG
+  if ((_stState == ST_IDLE) && _stInterval && !--_stCountdown) {
+    _stCountdown = _stInterval;
+    startSelfTest();
+  }
+  if ((_stState != ST_IDLE) && !stepSelfTest(v))
+    return false;
+#endif
+
+  for (uint8_t i = 0; i < 3; i++) {
+    if (_primed && (v[i] == _last[i])) {
+      if (_same[i] < 0xFFFF)
+        _same[i]++;
+    } else {
+      _same[i] = 0;
+    }
+  }
+  if (_primed)
+    checkNoise(v);
+  for (uint8_t i = 0; i < 3; i++)
+    _last[i] = v[i];
+  _primed = true;
+
+  update();
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the health monitor's findings
+    @return The health struct
+*/
+/**************************************************************************/
+const gyroHealth_t *FXAS21002C_Health::getHealth() { return &_health; }
+
+/**************************************************************************/
+/*!
+    @brief  Checks whether every check currently passes
+    @return True if the sensor looks healthy
+*/
+/**************************************************************************/
+bool FXAS21002C_Health::healthy() { return _health.ok; }
+
+/**************************************************************************/
+/*!
+    @brief  Clears all findings and restarts the checks, e.g. after the
+            sensor was reconfigured
+*/
+/**************************************************************************/
+void FXAS21002C_Health::reset() {
+  memset(&_health, 0, sizeof(_health));
+  _health.ok = true;
+  for (uint8_t i = 0; i < 3; i++) {
+    _last[i] = 0;
+    _same[i] = 0;
+    _diffSum[i] = 0;
+  }
+  _noiseCount = 0;
+  _primed = false;
+#ifndef FXAS21002C_NO_CONFIG
+  if (_stState != ST_IDLE)
+    _sensor->setSelfTest(false);
+  _stState = ST_IDLE;
+  _stCountdown = _stInterval;
+#endif
+}
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Adds a sample to the noise window and evaluates full windows.
+            Half the mean squared difference of consecutive samples
+            estimates the white noise variance.
+    @param  v
+            The x, y and z values
+*/
+/**************************************************************************/
+void FXAS21002C_Health::checkNoise(const int16_t *v) {
+  for (uint8_t i = 0; i < 3; i++) {
+    int32_t d = (int32_t)v[i] - _last[i];
+    if (d > NOISE_DIFF_CLAMP)
+      d = NOISE_DIFF_CLAMP;
+    if (d < -NOISE_DIFF_CLAMP)
+      d = -NOISE_DIFF_CLAMP;
+    _diffSum[i] += (uint32_t)(d * d);
+  }
+
+  if (++_noiseCount < FXAS21002C_HEALTH_NOISE_WINDOW)
+    return;
+
+  _health.quietAxes = 0;
+  _health.noisyAxes = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    uint16_t rms = isqrt(_diffSum[i] / (2 * FXAS21002C_HEALTH_NOISE_WINDOW));
+    _health.noise[i] = rms;
+    if (_minNoise && (rms < _minNoise))
+      _health.quietAxes |= 1 << i;
+    if (_maxNoise && (rms > _maxNoise))
+      _health.noisyAxes |= 1 << i;
+    _diffSum[i] = 0;
+  }
+  _noiseCount = 0;
+}
+
+#ifndef FXAS21002C_NO_CONFIG
+/**************************************************************************/
+/*!
+    @brief  Advances the self-test by one sample
+    @param  v
+            The x, y and z values
+    @return True if the sample is unaffected by the self-test
+*/
+/**************************************************************************/
+bool FXAS21002C_Health::stepSelfTest(const int16_t *v) {
+  switch (_stState) {
+  case ST_BASELINE:
+    for (uint8_t i = 0; i < 3; i++)
+      _stBase[i] += v[i];
+    if (++_stCount == FXAS21002C_HEALTH_ST_AVERAGE) {
+      _stCount = 0;
+      _stState = ST_SETTLE_ON;
+      if (!_sensor->setSelfTest(true)) {
+        /* Retry at the next interval rather than stall here */
+        _stState = ST_IDLE;
+      }
+    }
+    /* The baseline samples are ordinary samples */
+    return true;
+
+  case ST_SETTLE_ON:
+    if (++_stCount == FXAS21002C_HEALTH_ST_SETTLE + _stLatency) {
+      _stCount = 0;
+      _stState = ST_MEASURE;
+    }
+    return false;
+
+  case ST_MEASURE:
+    for (uint8_t i = 0; i < 3; i++)
+      _stSum[i] += v[i];
+    if (++_stCount == FXAS21002C_HEALTH_ST_AVERAGE) {
+      _stCount = 0;
+      _stState = ST_SETTLE_OFF;
+      _sensor->setSelfTest(false);
+      finishSelfTest();
+    }
+    return false;
+
+  case ST_SETTLE_OFF:
+    if (++_stCount == FXAS21002C_HEALTH_ST_SETTLE + _stLatency) {
+      _stCount = 0;
+      _stState = ST_IDLE;
+      /* Do not count the deflection step as a consecutive difference */
+      _primed = false;
+    }
+    return false;
+
+  default:
+    return true;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Evaluates the averaged self-test deflection
+*/
+/**************************************************************************/
+void FXAS21002C_Health::finishSelfTest() {
+  _health.selfTestAxes = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    int32_t d =
+        (_stSum[i] - _stBase[i]) / (int32_t)FXAS21002C_HEALTH_ST_AVERAGE;
+    _health.selfTest[i] = (int16_t)d;
+    if (d < 0)
+      d = -d;
+    if ((d < _stMin) || (d > _stMax))
+      _health.selfTestAxes |= 1 << i;
+  }
+  _health.selfTests++;
+  if (_health.selfTestAxes)
+    _health.selfTestFail++;
+  update();
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Refreshes the stuck flags and the overall verdict
+*/
+/**************************************************************************/
+void FXAS21002C_Health::update() {
+  _health.stuckAxes = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    if (_stuckLimit && (_same[i] >= _stuckLimit))
+      _health.stuckAxes |= 1 << i;
+  }
+
+  _health.ok = !(_health.stuckAxes | _health.quietAxes | _health.noisyAxes |
+                 _health.selfTestAxes);
+}
@@ -0,0 +1,124 @@
+/*!
+ * @file FXAS21002C_Health.h
+ *
+ * Sensor health monitor for the FXAS21002C: stuck output and noise checks
+ * on the sample stream, plus a periodic built-in self-test that runs
+ * alongside acquisition.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_HEALTH_H__
+#define __FXAS21002C_HEALTH_H__
+
+#include "Adafruit_FXAS21002C.h"
+
+/** Samples per noise estimate */
+#define FXAS21002C_HEALTH_NOISE_WINDOW (128)
+/** Samples averaged for the self-test baseline and deflection */
+#define FXAS21002C_HEALTH_ST_AVERAGE (16)
+/** Samples skipped after switching the self-test on or off */
+#define FXAS21002C_HEALTH_ST_SETTLE (8)
+
+/*!
+    Struct to store the health monitor's findings. Axis fields are
+    gyroAxis_t flags.
+*/
+typedef struct gyroHealth_s {
+  bool ok;               /**< No check currently fails */
+  uint8_t stuckAxes;     /**< Axes whose output has not changed */
+  uint8_t quietAxes;     /**< Axes with less noise than the lower limit */
+  uint8_t noisyAxes;     /**< Axes with more noise than the upper limit */
+  uint16_t noise[3];     /**< Last x/y/z noise estimate, LSB rms */
+  uint8_t selfTestAxes;  /**< Axes that failed the last self-test */
+  int16_t selfTest[3];   /**< Last x/y/z self-test deflection, LSB */
+  uint32_t selfTests;    /**< Number of completed self-tests */
+  uint32_t selfTestFail; /**< Number of failed self-tests */
+} gyroHealth_t;
+
+/**************************************************************************/
+/*!
+    @brief  Checks the samples an application already reads for signs of a
+            failed sensor. Pass every raw sample to addSample(); it costs a
+            few integer operations and no bus traffic, except for the two
+            register updates that switch the self-test on and off.
+
+            Noise is estimated from the difference of consecutive samples,
+            so slow motion does not count as noise. A sensor at rest that
+            reports (nearly) constant values is dead or saturated; one that
+            is much noisier than expected is damaged or badly mounted.
+
+            The self-test is spread over the sample stream: addSample()
+            averages a baseline, sets the ST bit, averages the deflected
+            output and clears the bit again, taking about 50 samples. The
+            sensor keeps sampling throughout, but addSample() returns false
+            for the samples the self-test offsets, which the application
+            should drop or replace. When samples reach addSample() through
+            the FIFO, set the queueing latency with setSelfTestLatency()
+            so samples taken before a toggle are not mistaken for ones
+            taken after it.
+*/
+/**************************************************************************/
+class FXAS21002C_Health {
+public:
+  FXAS21002C_Health(Adafruit_FXAS21002C &sensor);
+
+  void setStuckLimit(uint16_t samples);
+  void setNoiseLimits(uint16_t minRms, uint16_t maxRms = 0);
+#ifndef FXAS21002C_NO_CONFIG
+  void setSelfTestInterval(uint32_t samples);
+  void setSelfTestLimits(int16_t minLsb, int16_t maxLsb);
+  void setSelfTestLatency(uint8_t samples);
+  void startSelfTest();
+#endif
+
+  bool addSample(const gyroRawData_t &sample);
+
+  const gyroHealth_t *getHealth();
+  bool healthy();
+  void reset();
+
+private:
+  /** Self-test progress */
+  typedef enum {
+    ST_IDLE,
+    ST_BASELINE,
+    ST_SETTLE_ON,
+    ST_MEASURE,
+    ST_SETTLE_OFF
+  } selfTestState_t;
+
+  void checkNoise(const int16_t *v);
+#ifndef FXAS21002C_NO_CONFIG
+  bool stepSelfTest(const int16_t *v);
+  void finishSelfTest();
+#endif
+  void update();
+
+  Adafruit_FXAS21002C *_sensor;
+  gyroHealth_t _health;
+
+  uint16_t _stuckLimit = 100;
+  uint16_t _minNoise = 1;
+  uint16_t _maxNoise = 0;
+
+  int16_t _last[3];
+  uint16_t _same[3];    ///< Consecutive identical samples per axis
+  uint32_t _diffSum[3]; ///< Sum of squared consecutive differences
+  uint8_t _noiseCount;  ///< Samples in the current noise window
+  bool _primed;         ///< _last holds a sample
+
+#ifndef FXAS21002C_NO_CONFIG
+  uint32_t _stInterval = 0;
+  int16_t _stMin = 1000;
+  int16_t _stMax = 32000;
+  uint32_t _stCountdown = 0; ///< Samples until the next self-test
+  uint8_t _stLatency = 0;    ///< Samples queued ahead of addSample()
+  selfTestState_t _stState = ST_IDLE;
+  uint16_t _stCount = 0; ///< Samples in the current self-test phase
+  int32_t _stBase[3];    ///< Baseline sum
+  int32_t _stSum[3];     ///< Deflected output sum
+#endif
+};
+
+#endif
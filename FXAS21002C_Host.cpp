@@ -0,0 +1,99 @@
+/*!
+ * @file FXAS21002C_Host.cpp
+ *
+ * Arduino timing functions for building the driver on a POSIX host.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Host.h"
+
+#ifdef FXAS21002C_HOST
+
+#include <time.h>
+
+/**************************************************************************/
+/*!
+    @brief  The monotonic system clock
+*/
+/**************************************************************************/
+class SystemClock : public FXAS21002C_Clock {
+public:
+  uint64_t now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  }
+
+  void sleep(uint32_t us) {
+    struct timespec ts;
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (long)(us % 1000000) * 1000;
+    while (nanosleep(&ts, &ts) != 0)
+      ;
+  }
+};
+
+static SystemClock system_clock;
+static FXAS21002C_Clock *active_clock = &system_clock;
+
+/**************************************************************************/
+/*!
+    @brief  Installs the time source for millis(), micros() and delay()
+    @param  clock
+            The clock, NULL for the system clock. It must outlive its use.
+*/
+/**************************************************************************/
+void FXAS21002C_Clock::set(FXAS21002C_Clock *clock) {
+  active_clock = clock ? clock : &system_clock;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the installed time source
+    @return The clock
+*/
+/**************************************************************************/
+FXAS21002C_Clock *FXAS21002C_Clock::get() { return active_clock; }
+
+/**************************************************************************/
+/*!
+    @brief  Arduino millis() on the installed clock
+    @return Milliseconds since the clock's start
+*/
+/**************************************************************************/
+unsigned long millis() { return (unsigned long)(active_clock->now() / 1000); }
+
+/**************************************************************************/
+/*!
+    @brief  Arduino micros() on the installed clock
+    @return Microseconds since the clock's start
+*/
+/**************************************************************************/
+unsigned long micros() { return (unsigned long)active_clock->now(); }
+
+/**************************************************************************/
+/*!
+    @brief  Arduino delay() on the installed clock
+    @param  ms
+            Milliseconds to wait
+*/
+/**************************************************************************/
+void delay(unsigned long ms) {
+  while (ms > 4000000) {
+    active_clock->sleep(4000000000UL);
+    ms -= 4000000;
+  }
+  active_clock->sleep(ms * 1000);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Arduino delayMicroseconds() on the installed clock
+    @param  us
+            Microseconds to wait
+*/
+/**************************************************************************/
+void delayMicroseconds(unsigned int us) { active_clock->sleep(us); }
+
+#endif
@@ -0,0 +1,97 @@
+/*!
+ * @file FXAS21002C_Host.h
+ *
+ * The few Arduino API pieces the driver uses, for building it as a plain
+ * C++ library on a POSIX host (embedded Linux, CI) without an Arduino core.
+ * Adafruit_FXAS21002C.h includes this instead of Arduino.h, Wire.h and
+ * BusIO whenever ARDUINO is not defined.
+ *
+ * On a host only begin(FXAS21002C_Transport &) exists, e.g. with
+ * FXAS21002C_LinuxI2C or FXAS21002C_Sim. Put Adafruit_Sensor.h (which
+ * builds without Arduino) on the include path, or define
+ * FXAS21002C_NO_FLOAT.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_HOST_H__
+#define __FXAS21002C_HOST_H__
+
+#ifndef ARDUINO
+
+/** The driver is built without an Arduino core */
+#define FXAS21002C_HOST
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/** Arduino's alias for bool */
+typedef bool boolean;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+/**************************************************************************/
+/*!
+    @brief  Byte sink with the Arduino Print write() interface, as taken by
+            FXAS21002C_Trace::beginRecord()
+*/
+/**************************************************************************/
+class Print {
+public:
+  virtual ~Print() {}
+
+  /*!
+      @brief  Writes one byte
+      @param  b  The byte
+      @return 1 if it was written
+  */
+  virtual size_t write(uint8_t b) = 0;
+
+  /*!
+      @brief  Writes a buffer
+      @param  buffer  The bytes
+      @param  size    Number of bytes
+      @return The number of bytes written
+  */
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size-- && write(*buffer++))
+      n++;
+    return n;
+  }
+};
+
+/**************************************************************************/
+/*!
+    @brief  Time source behind millis(), micros() and delay() on a host.
+            The default is the monotonic system clock; a simulation
+            installs its own with set() to run on virtual time.
+*/
+/**************************************************************************/
+class FXAS21002C_Clock {
+public:
+  virtual ~FXAS21002C_Clock() {}
+
+  /*!
+      @brief  Gets the current time
+      @return Microseconds since an arbitrary start
+  */
+  virtual uint64_t now() = 0;
+
+  /*!
+      @brief  Waits, or lets virtual time pass
+      @param  us  Microseconds
+  */
+  virtual void sleep(uint32_t us) = 0;
+
+  static void set(FXAS21002C_Clock *clock);
+  static FXAS21002C_Clock *get();
+};
+
+#endif
+
+#endif
@@ -0,0 +1,241 @@
+/*!
+ * @file FXAS21002C_LinuxI2C.cpp
+ *
+ * Linux userspace transport for the FXAS21002C driver using /dev/i2c-N.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_LinuxI2C.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+/***************************************************************************
+ DESTRUCTOR
+ ***************************************************************************/
+
+FXAS21002C_LinuxI2C::~FXAS21002C_LinuxI2C() { end(); }
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Opens an i2c-dev device node
+    @param  device
+            The device node, e.g. "/dev/i2c-1"
+    @param  addr
+            The 7-bit address of the sensor
+    @return True if the node could be opened
+*/
+/**************************************************************************/
+bool FXAS21002C_LinuxI2C::begin(const char *device, uint8_t addr) {
+  end();
+  int fd = open(device, O_RDWR | O_CLOEXEC);
+  if (fd < 0) {
+    _errno = errno;
+    return false;
+  }
+
+  begin(fd, addr);
+  _owned = true;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Uses an already open i2c-dev file descriptor, which is not
+            closed by end()
+    @param  fd
+            The file descriptor
+    @param  addr
+            The 7-bit address of the sensor
+    @return True if the descriptor is valid
+*/
+/**************************************************************************/
+bool FXAS21002C_LinuxI2C::begin(int fd, uint8_t addr) {
+  if (_fd != fd)
+    end();
+  _fd = fd;
+  _addr = addr;
+  _smbus = false;
+  _errno = 0;
+  return _fd >= 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Closes the device node if begin(device) opened it
+*/
+/**************************************************************************/
+void FXAS21002C_LinuxI2C::end() {
+  if (_owned && (_fd >= 0))
+    close(_fd);
+  _fd = -1;
+  _owned = false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads consecutive registers with one combined transfer
+    @param  reg     The first register to read
+    @param  buffer  Receives the register contents
+    @param  len     Number of bytes to read
+    @return True if the transfer succeeded
+*/
+/**************************************************************************/
+bool FXAS21002C_LinuxI2C::readRegisters(uint8_t reg, uint8_t *buffer,
+                                        size_t len) {
+  if (_fd < 0)
+    return false;
+  if (_smbus)
+    return smbusRead(reg, buffer, len);
+
+  struct i2c_msg msgs[2];
+  msgs[0].addr = _addr;
+  msgs[0].flags = 0;
+  msgs[0].len = 1;
+  msgs[0].buf = &reg;
+  msgs[1].addr = _addr;
+  msgs[1].flags = I2C_M_RD;
+  msgs[1].len = (__u16)len;
+  msgs[1].buf = buffer;
+
+  struct i2c_rdwr_ioctl_data xfer;
+  xfer.msgs = msgs;
+  xfer.nmsgs = 2;
+  if (ioctl(_fd, I2C_RDWR, &xfer) == 2)
+    return true;
+
+  _errno = errno;
+  if ((_errno == EOPNOTSUPP) || (_errno == ENOTTY)) {
+    _smbus = true;
+    return smbusRead(reg, buffer, len);
+  }
+  return false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes one register
+    @param  reg    The register to write
+    @param  value  The new register value
+    @return True if the transfer succeeded
+*/
+/**************************************************************************/
+bool FXAS21002C_LinuxI2C::writeRegister(uint8_t reg, uint8_t value) {
+  if (_fd < 0)
+    return false;
+
+  if (!_smbus) {
+    uint8_t buffer[2] = {reg, value};
+    struct i2c_msg msg;
+    msg.addr = _addr;
+    msg.flags = 0;
+    msg.len = 2;
+    msg.buf = buffer;
+
+    struct i2c_rdwr_ioctl_data xfer;
+    xfer.msgs = &msg;
+    xfer.nmsgs = 1;
+    if (ioctl(_fd, I2C_RDWR, &xfer) == 1)
+      return true;
+
+    _errno = errno;
+    if ((_errno != EOPNOTSUPP) && (_errno != ENOTTY))
+      return false;
+    _smbus = true;
+  }
+
+  if (ioctl(_fd, I2C_SLAVE, _addr) < 0) {
+    _errno = errno;
+    return false;
+  }
+
+  union i2c_smbus_data data;
+  data.byte = value;
+  struct i2c_smbus_ioctl_data args;
+  args.read_write = I2C_SMBUS_WRITE;
+  args.command = reg;
+  args.size = I2C_SMBUS_BYTE_DATA;
+  args.data = &data;
+  if (ioctl(_fd, I2C_SMBUS, &args) < 0) {
+    _errno = errno;
+    return false;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks whether the SMBus fallback is in use
+    @return True if the adapter rejected I2C_RDWR
+*/
+/**************************************************************************/
+bool FXAS21002C_LinuxI2C::smbus() { return _smbus; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the errno of the last failed call
+    @return The errno value, 0 if nothing failed yet
+*/
+/**************************************************************************/
+int FXAS21002C_LinuxI2C::lastError() { return _errno; }
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Reads consecutive registers with SMBus I2C block reads, in
+            chunks of at most FXAS21002C_LINUXI2C_SMBUS_CHUNK bytes that
+            each start at 'reg'. That matches how the sensor serves FIFO
+            bursts from OUT_X_MSB; other registers are read in one chunk.
+    @param  reg     The first register to read
+    @param  buffer  Receives the register contents
+    @param  len     Number of bytes to read
+    @return True if every transfer succeeded
+*/
+/**************************************************************************/
+bool FXAS21002C_LinuxI2C::smbusRead(uint8_t reg, uint8_t *buffer,
+                                    size_t len) {
+  if (ioctl(_fd, I2C_SLAVE, _addr) < 0) {
+    _errno = errno;
+    return false;
+  }
+
+  while (len) {
+    size_t n = len;
+    if (n > FXAS21002C_LINUXI2C_SMBUS_CHUNK)
+      n = FXAS21002C_LINUXI2C_SMBUS_CHUNK;
+
+    union i2c_smbus_data data;
+    data.block[0] = (__u8)n;
+    struct i2c_smbus_ioctl_data args;
+    args.read_write = I2C_SMBUS_READ;
+    args.command = reg;
+    args.size = I2C_SMBUS_I2C_BLOCK_DATA;
+    args.data = &data;
+    if (ioctl(_fd, I2C_SMBUS, &args) < 0) {
+      _errno = errno;
+      return false;
+    }
+
+    memcpy(buffer, &data.block[1], n);
+    buffer += n;
+    len -= n;
+  }
+  return true;
+}
+
+#endif
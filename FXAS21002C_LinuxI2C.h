@@ -0,0 +1,58 @@
+/*!
+ * @file FXAS21002C_LinuxI2C.h
+ *
+ * Linux userspace transport for the FXAS21002C driver using /dev/i2c-N.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_LINUXI2C_H__
+#define __FXAS21002C_LINUXI2C_H__
+
+#if defined(__linux__)
+
+#include "FXAS21002C_Transport.h"
+
+/** Largest burst the SMBus fallback reads at once; a whole number of
+ * samples so chunked FIFO reads stay aligned */
+#define FXAS21002C_LINUXI2C_SMBUS_CHUNK (30)
+
+/**************************************************************************/
+/*!
+    @brief  Talks to the sensor through the Linux i2c-dev interface. Burst
+            reads are one I2C_RDWR ioctl holding the register address write
+            and the read, joined by a repeated start.
+
+            Adapters that only speak SMBus, such as the i2c-stub module
+            used to test without hardware ("modprobe i2c-stub
+            chip_addr=0x21"), reject I2C_RDWR; the transport then falls
+            back to SMBus I2C block transfers.
+*/
+/**************************************************************************/
+class FXAS21002C_LinuxI2C : public FXAS21002C_Transport {
+public:
+  ~FXAS21002C_LinuxI2C();
+
+  bool begin(const char *device, uint8_t addr = 0x21);
+  bool begin(int fd, uint8_t addr = 0x21);
+  void end();
+
+  bool readRegisters(uint8_t reg, uint8_t *buffer, size_t len);
+  bool writeRegister(uint8_t reg, uint8_t value);
+
+  bool smbus();
+  int lastError();
+
+private:
+  bool smbusRead(uint8_t reg, uint8_t *buffer, size_t len);
+
+  int _fd = -1;
+  uint8_t _addr = 0;
+  bool _owned = false; ///< end() closes _fd, it was opened by begin(device)
+  bool _smbus = false; ///< Adapter rejected I2C_RDWR, use SMBus transfers
+  int _errno = 0;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,373 @@
+/*!
+ * @file FXAS21002C_RiceLog.cpp
+ *
+ * Lossless compressed record format for long raw FXAS21002C logs.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_RiceLog.h"
+
+/** Bits of an escaped residual; second order residuals of 16 bit samples
+ * need 18 bits once zigzag mapped */
+#define LITERAL_BITS (18)
+/** Largest Rice parameter, it has to fit a nibble */
+#define MAX_K (15)
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+static void putU16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void putU32(uint8_t *p, uint32_t v) {
+  putU16(p, v & 0xFFFF);
+  putU16(p + 2, v >> 16);
+}
+
+static uint16_t getU16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static uint32_t getU32(const uint8_t *p) {
+  return getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+static int16_t axisValue(const gyroRawData_t &s, uint8_t axis) {
+  return axis == 0 ? s.x : (axis == 1 ? s.y : s.z);
+}
+
+/* Zigzag mapped prediction residual of sample i >= 1 */
+static uint32_t residual(const gyroRawData_t *samples, uint16_t i,
+                         uint8_t axis) {
+  int32_t prediction = axisValue(samples[i - 1], axis);
+  if (i >= 2)
+    prediction = 2 * prediction - axisValue(samples[i - 2], axis);
+  int32_t r = axisValue(samples[i], axis) - prediction;
+  return ((uint32_t)r << 1) ^ (uint32_t)(r >> 31);
+}
+
+/* Picks the Rice parameter with the smallest exact cost for one axis */
+static uint8_t bestK(const gyroRawData_t *samples, uint16_t count,
+                     uint8_t axis) {
+  uint8_t best = 0;
+  uint32_t bestBits = 0xFFFFFFFF;
+  for (uint8_t k = 0; k <= MAX_K; k++) {
+    uint32_t bits = 0;
+    for (uint16_t i = 1; i < count; i++) {
+      uint32_t q = residual(samples, i, axis) >> k;
+      bits += (q < FXAS21002C_RICELOG_ESCAPE)
+                  ? q + 1 + k
+                  : FXAS21002C_RICELOG_ESCAPE + LITERAL_BITS;
+    }
+    if (bits < bestBits) {
+      bestBits = bits;
+      best = k;
+    }
+  }
+  return best;
+}
+
+/** MSB first bit writer over a byte buffer */
+typedef struct {
+  uint8_t *out;
+  size_t size;
+  size_t bit;
+  bool overflow;
+} BitWriter;
+
+static void putBits(BitWriter *w, uint32_t v, uint8_t n) {
+  while (n--) {
+    size_t byte = w->bit >> 3;
+    if (byte >= w->size) {
+      w->overflow = true;
+      return;
+    }
+    if (!(w->bit & 7))
+      w->out[byte] = 0;
+    if ((v >> n) & 1)
+      w->out[byte] |= 0x80 >> (w->bit & 7);
+    w->bit++;
+  }
+}
+
+/** MSB first bit reader over a byte buffer */
+typedef struct {
+  const uint8_t *in;
+  size_t size;
+  size_t bit;
+} BitReader;
+
+static bool getBits(BitReader *r, uint8_t n, uint32_t *v) {
+  if (r->bit + n > r->size * 8)
+    return false;
+  *v = 0;
+  while (n--) {
+    *v = (*v << 1) | ((r->in[r->bit >> 3] >> (7 - (r->bit & 7))) & 1);
+    r->bit++;
+  }
+  return true;
+}
+
+/* Writes the residuals of samples 1 to count - 1 of one axis */
+static void putAxis(BitWriter *w, const gyroRawData_t *samples, uint16_t count,
+                    uint8_t axis, uint8_t k) {
+  for (uint16_t i = 1; i < count; i++) {
+    uint32_t u = residual(samples, i, axis);
+    uint32_t q = u >> k;
+    if (q < FXAS21002C_RICELOG_ESCAPE) {
+      while (q--)
+        putBits(w, 1, 1);
+      putBits(w, 0, 1);
+      putBits(w, u, k);
+    } else {
+      for (q = 0; q < FXAS21002C_RICELOG_ESCAPE; q++)
+        putBits(w, 1, 1);
+      putBits(w, u, LITERAL_BITS);
+    }
+  }
+}
+
+/* Reads the residuals of one axis and rebuilds samples 1 to count - 1 from
+ * sample 0. 'first' is sample 0's data, 'stride' the distance in bytes
+ * between consecutive samples' data. */
+static bool getAxis(BitReader *r, gyroRawData_t *first, size_t stride,
+                    uint16_t count, uint8_t axis, uint8_t k) {
+  int16_t prev2 = 0;
+  int16_t prev = axisValue(*first, axis);
+  uint8_t *p = (uint8_t *)first;
+  for (uint16_t i = 1; i < count; i++) {
+    uint32_t q = 0, bit = 1, u;
+    while ((q < FXAS21002C_RICELOG_ESCAPE) && bit) {
+      if (!getBits(r, 1, &bit))
+        return false;
+      q += bit;
+    }
+    if (bit) {
+      if (!getBits(r, LITERAL_BITS, &u))
+        return false;
+    } else {
+      if (!getBits(r, k, &u))
+        return false;
+      u |= q << k;
+    }
+
+    int32_t prediction = (i >= 2) ? 2 * (int32_t)prev - prev2 : prev;
+    int32_t residual = (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+    int16_t v = (int16_t)(prediction + residual);
+    gyroRawData_t *s = (gyroRawData_t *)(p + i * stride);
+    if (axis == 0)
+      s->x = v;
+    else if (axis == 1)
+      s->y = v;
+    else
+      s->z = v;
+    prev2 = prev;
+    prev = v;
+  }
+  return true;
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Encodes a burst of samples, e.g. one FIFO drain, as one block
+    @param  samples
+            The raw samples, oldest first
+    @param  count
+            Number of samples, 1 to 256
+    @param  timestamp
+            Time of the first sample in microseconds
+    @param  period
+            Sample period in microseconds
+    @param[out] out
+            Destination buffer, FXAS21002C_RICELOG_MAX_BLOCK(count) bytes
+            always suffice
+    @param  outSize
+            Size of 'out' in bytes
+    @return The number of bytes written, 0 if 'count' is out of range or
+            'out' was too small
+*/
+/**************************************************************************/
+size_t FXAS21002C_RiceLog::encode(const gyroRawData_t *samples,
+                                  uint16_t count, uint32_t timestamp,
+                                  uint32_t period, uint8_t *out,
+                                  size_t outSize) {
+  if ((count == 0) || (count > 256) ||
+      (outSize < FXAS21002C_RICELOG_HEADER_SIZE))
+    return 0;
+
+  uint8_t k[3];
+  for (uint8_t axis = 0; axis < 3; axis++)
+    k[axis] = bestK(samples, count, axis);
+
+  out[0] = FXAS21002C_RICELOG_MARKER;
+  out[1] = count - 1;
+  putU32(out + 4, timestamp);
+  putU32(out + 8, period);
+  putU16(out + 12, samples[0].x);
+  putU16(out + 14, samples[0].y);
+  putU16(out + 16, samples[0].z);
+  putU16(out + 18, k[0] | (k[1] << 4) | (k[2] << 8));
+
+  BitWriter w = {out + FXAS21002C_RICELOG_HEADER_SIZE,
+                 outSize - FXAS21002C_RICELOG_HEADER_SIZE, 0, false};
+  for (uint8_t axis = 0; axis < 3; axis++)
+    putAxis(&w, samples, count, axis, k[axis]);
+  if (w.overflow)
+    return 0;
+
+  size_t size = FXAS21002C_RICELOG_HEADER_SIZE + (w.bit + 7) / 8;
+  if (size > 0xFFFF)
+    return 0;
+  putU16(out + 2, size);
+  return size;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes one block. The decoder keeps no state, so blocks found
+            with blockSize() can be decoded in parallel.
+    @param  in
+            Pointer to the start of a block
+    @param  len
+            Number of bytes available at 'in'
+    @param[out] out
+            Destination for the decoded samples
+    @param  maxSamples
+            Capacity of 'out'; up to 256 samples may be needed
+    @param[out] used
+            If not NULL, receives the size of the block in bytes
+    @return The number of samples decoded, or -1 if 'in' does not start
+            with a complete, valid block or 'out' is too small
+*/
+/**************************************************************************/
+int16_t FXAS21002C_RiceLog::decode(const uint8_t *in, size_t len,
+                                   gyroSample_t *out, uint16_t maxSamples,
+                                   size_t *used) {
+  size_t size = blockSize(in, len);
+  if (!size)
+    return -1;
+
+  uint16_t count = in[1] + 1;
+  if (count > maxSamples)
+    return -1;
+
+  uint32_t timestamp = getU32(in + 4);
+  uint32_t period = getU32(in + 8);
+  uint16_t kBits = getU16(in + 18);
+  out[0].data.x = (int16_t)getU16(in + 12);
+  out[0].data.y = (int16_t)getU16(in + 14);
+  out[0].data.z = (int16_t)getU16(in + 16);
+
+  BitReader r = {in + FXAS21002C_RICELOG_HEADER_SIZE,
+                 size - FXAS21002C_RICELOG_HEADER_SIZE, 0};
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    if (!getAxis(&r, &out[0].data, sizeof(gyroSample_t), count, axis,
+                 (kBits >> (4 * axis)) & 0x0F))
+      return -1;
+  }
+
+  for (uint16_t i = 0; i < count; i++)
+    out[i].timestamp = timestamp + i * period;
+
+  if (used)
+    *used = size;
+  return count;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the size of the block at 'in' without decoding it, to
+            walk a log or split it between threads
+    @param  in
+            Pointer to the start of a block
+    @param  len
+            Number of bytes available at 'in'
+    @return The size of the block in bytes, 0 if 'in' does not start with
+            a complete block
+*/
+/**************************************************************************/
+size_t FXAS21002C_RiceLog::blockSize(const uint8_t *in, size_t len) {
+  if ((len < FXAS21002C_RICELOG_HEADER_SIZE) ||
+      (in[0] != FXAS21002C_RICELOG_MARKER))
+    return 0;
+
+  size_t size = getU16(in + 2);
+  if ((size < FXAS21002C_RICELOG_HEADER_SIZE) || (size > len))
+    return 0;
+  return size;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Encodes one axis of a burst as a column of its own
+    @param  samples
+            The raw samples, oldest first
+    @param  count
+            Number of samples, at least 1
+    @param  axis
+            0 for x, 1 for y, 2 for z
+    @param[out] out
+            Destination buffer, FXAS21002C_RICELOG_MAX_AXIS(count) bytes
+            always suffice
+    @param  outSize
+            Size of 'out' in bytes
+    @return The number of bytes written, 0 if 'out' was too small
+*/
+/**************************************************************************/
+size_t FXAS21002C_RiceLog::encodeAxis(const gyroRawData_t *samples,
+                                      uint16_t count, uint8_t axis,
+                                      uint8_t *out, size_t outSize) {
+  if (!count || (axis > 2) || (outSize < 3))
+    return 0;
+
+  uint8_t k = bestK(samples, count, axis);
+  putU16(out, axisValue(samples[0], axis));
+  out[2] = k;
+
+  BitWriter w = {out + 3, outSize - 3, 0, false};
+  putAxis(&w, samples, count, axis, k);
+  if (w.overflow)
+    return 0;
+  return 3 + (w.bit + 7) / 8;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes a column written by encodeAxis() into one axis of
+            'out', leaving the other axes untouched
+    @param  in
+            The column
+    @param  len
+            Size of the column in bytes
+    @param[out] out
+            Destination samples
+    @param  count
+            Number of samples in the column
+    @param  axis
+            0 for x, 1 for y, 2 for z
+    @return False if the column is truncated or invalid
+*/
+/**************************************************************************/
+bool FXAS21002C_RiceLog::decodeAxis(const uint8_t *in, size_t len,
+                                    gyroRawData_t *out, uint16_t count,
+                                    uint8_t axis) {
+  if (!count || (axis > 2) || (len < 3) || (in[2] > MAX_K))
+    return false;
+
+  int16_t v = (int16_t)getU16(in);
+  if (axis == 0)
+    out[0].x = v;
+  else if (axis == 1)
+    out[0].y = v;
+  else
+    out[0].z = v;
+
+  BitReader r = {in + 3, len - 3, 0};
+  return getAxis(&r, out, sizeof(gyroRawData_t), count, axis, in[2]);
+}
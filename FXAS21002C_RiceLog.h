@@ -0,0 +1,78 @@
+/*!
+ * @file FXAS21002C_RiceLog.h
+ *
+ * Lossless compressed record format for long raw FXAS21002C logs. Each axis
+ * is predicted from the previous two samples and the prediction residuals
+ * are Rice coded with a parameter chosen per block and axis.
+ *
+ * Each block starts with a 20 byte header, little endian:
+ *
+ *   uint8_t  marker      'R' (0x52)
+ *   uint8_t  count       number of samples - 1
+ *   uint16_t size        size of the whole block in bytes
+ *   uint32_t timestamp   time of the first sample in microseconds
+ *   uint32_t period      sample period in microseconds (1 / ODR)
+ *   int16_t  x, y, z     absolute raw values of the first sample
+ *   uint16_t k           Rice parameters, x in bits 3:0, y 7:4, z 11:8
+ *
+ * followed by a bitstream (MSB first, zero padded to a byte) holding the
+ * residuals of samples 1 to count - 1 for x, then y, then z. Sample 1 is
+ * predicted by sample 0, later ones by 2 * s[n-1] - s[n-2]. A residual is
+ * zigzag mapped to 'u' and stored as u >> k one bits, a zero bit and the
+ * low k bits of u; if u >> k reaches FXAS21002C_RICELOG_ESCAPE, the one
+ * bits are followed by u in 18 bits instead.
+ *
+ * encodeAxis() stores a single axis the same way, as a column of its own:
+ * the first value as int16_t, one byte holding k, and the bitstream.
+ *
+ * Blocks are self contained and carry their size, so a reader can skip
+ * from block to block and hand blocks to several threads, as
+ * extras/convert/fxas21002c_convert.cpp does. Encoding uses integers only
+ * and no memory besides the output; neither side has Arduino dependencies,
+ * so the decoder builds as-is on a host.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_RICELOG_H__
+#define __FXAS21002C_RICELOG_H__
+
+#include "FXAS21002C_Types.h"
+
+/** Block marker byte */
+#define FXAS21002C_RICELOG_MARKER (0x52)
+/** Size of a block header in bytes */
+#define FXAS21002C_RICELOG_HEADER_SIZE (20)
+/** Rice quotient that switches to an 18 bit literal */
+#define FXAS21002C_RICELOG_ESCAPE (24)
+/** Worst case size of a single axis column holding 'n' samples */
+#define FXAS21002C_RICELOG_MAX_AXIS(n)                                         \
+  (3 + (((n)-1) * (FXAS21002C_RICELOG_ESCAPE + 18) + 7) / 8)
+/** Worst case size of a block holding 'n' samples */
+#define FXAS21002C_RICELOG_MAX_BLOCK(n)                                        \
+  (FXAS21002C_RICELOG_HEADER_SIZE +                                            \
+   (((n)-1) * 3 * (FXAS21002C_RICELOG_ESCAPE + 18) + 7) / 8)
+
+/**************************************************************************/
+/*!
+    @brief  Encoder and decoder for Rice coded sample blocks. Blocks of one
+            FIFO drain (FXAS21002C_FIFO_DEPTH samples) compress well while
+            keeping the header overhead low.
+*/
+/**************************************************************************/
+class FXAS21002C_RiceLog {
+public:
+  static size_t encode(const gyroRawData_t *samples, uint16_t count,
+                       uint32_t timestamp, uint32_t period, uint8_t *out,
+                       size_t outSize);
+  static int16_t decode(const uint8_t *in, size_t len, gyroSample_t *out,
+                        uint16_t maxSamples, size_t *used = NULL);
+  static size_t blockSize(const uint8_t *in, size_t len);
+
+  static size_t encodeAxis(const gyroRawData_t *samples, uint16_t count,
+                           uint8_t axis, uint8_t *out, size_t outSize);
+  static bool decodeAxis(const uint8_t *in, size_t len, gyroRawData_t *out,
+                         uint16_t count, uint8_t axis);
+};
+
+#endif
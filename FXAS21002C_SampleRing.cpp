@@ -0,0 +1,120 @@
+/*!
+ * @file FXAS21002C_SampleRing.cpp
+ *
+ * Lock-free single-producer/single-consumer ring of timestamped raw
+ * FXAS21002C samples.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_SampleRing.h"
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a new FXAS21002C_SampleRing class
+    @param  buffer
+            Storage for the samples, owned by the caller
+    @param  capacity
+            Number of samples in 'buffer'. Only the largest power of two
+            not above 'capacity' (and not above half the index range, i.e.
+            128 on AVR) is used, so the free-running indices can wrap.
+*/
+/**************************************************************************/
+FXAS21002C_SampleRing::FXAS21002C_SampleRing(gyroSample_t *buffer,
+                                             fxas_ring_index_t capacity) {
+  const fxas_ring_index_t limit = (fxas_ring_index_t)(~0) / 2 + 1;
+  fxas_ring_index_t size = 1;
+  while ((size < limit) && ((fxas_ring_index_t)(size << 1) <= capacity))
+    size <<= 1;
+
+  _buffer = capacity ? buffer : NULL;
+  _mask = size - 1;
+  _head = 0;
+  _tail = 0;
+  _overruns = 0;
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Appends a sample. Producer side only.
+    @param  sample
+            The sample to append
+    @return True if the sample was stored, false if the ring was full (the
+            sample is dropped and counted as an overrun)
+*/
+/**************************************************************************/
+bool FXAS21002C_SampleRing::push(const gyroSample_t &sample) {
+  fxas_ring_index_t head = _head;
+  fxas_ring_index_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+
+  if (!_buffer || ((fxas_ring_index_t)(head - tail) > _mask)) {
+    _overruns++;
+    return false;
+  }
+
+  _buffer[head & _mask] = sample;
+  __atomic_store_n(&_head, (fxas_ring_index_t)(head + 1), __ATOMIC_RELEASE);
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Removes the oldest sample. Consumer side only.
+    @param[out] sample
+                The oldest sample in the ring
+    @return True if a sample was returned, false if the ring was empty
+*/
+/**************************************************************************/
+bool FXAS21002C_SampleRing::pop(gyroSample_t *sample) {
+  fxas_ring_index_t tail = _tail;
+  fxas_ring_index_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+
+  if (head == tail)
+    return false;
+
+  *sample = _buffer[tail & _mask];
+  __atomic_store_n(&_tail, (fxas_ring_index_t)(tail + 1), __ATOMIC_RELEASE);
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of samples waiting to be popped. Exact on the
+            consumer side, a lower bound of the free space on the producer
+            side.
+    @return The number of queued samples
+*/
+/**************************************************************************/
+fxas_ring_index_t FXAS21002C_SampleRing::available() {
+  return (fxas_ring_index_t)(__atomic_load_n(&_head, __ATOMIC_ACQUIRE) -
+                             __atomic_load_n(&_tail, __ATOMIC_ACQUIRE));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the usable capacity of the ring
+    @return The maximum number of queued samples
+*/
+/**************************************************************************/
+fxas_ring_index_t FXAS21002C_SampleRing::capacity() {
+  return _buffer ? _mask + 1 : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of samples dropped because the ring was full
+    @return The overrun count since construction. On 8-bit targets the
+            read is not atomic against push(), so it may rarely be torn.
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_SampleRing::overruns() { return _overruns; }
@@ -0,0 +1,51 @@
+/*!
+ * @file FXAS21002C_SampleRing.h
+ *
+ * Lock-free single-producer/single-consumer ring of timestamped raw
+ * FXAS21002C samples, for handing data from an interrupt (or another core)
+ * to the main loop.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_SAMPLERING_H__
+#define __FXAS21002C_SAMPLERING_H__
+
+#include "Adafruit_FXAS21002C.h"
+
+#if defined(__AVR__)
+/** Ring index type, single byte so loads and stores are atomic on AVR */
+typedef uint8_t fxas_ring_index_t;
+#else
+/** Ring index type */
+typedef uint16_t fxas_ring_index_t;
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  SPSC ring buffer of gyroSample_t in caller provided storage.
+            push() may only be called from one context (e.g. an ISR) and
+            pop() from one other context (e.g. loop()). The only shared
+            state is the head and tail index, which are published with
+            acquire/release atomics, so no critical section is needed.
+*/
+/**************************************************************************/
+class FXAS21002C_SampleRing {
+public:
+  FXAS21002C_SampleRing(gyroSample_t *buffer, fxas_ring_index_t capacity);
+
+  bool push(const gyroSample_t &sample);
+  bool pop(gyroSample_t *sample);
+  fxas_ring_index_t available();
+  fxas_ring_index_t capacity();
+  uint32_t overruns();
+
+private:
+  gyroSample_t *_buffer;
+  fxas_ring_index_t _mask;
+  fxas_ring_index_t _head; ///< Written by the producer only
+  fxas_ring_index_t _tail; ///< Written by the consumer only
+  uint32_t _overruns;      ///< Written by the producer only
+};
+
+#endif
@@ -0,0 +1,357 @@
+/*!
+ * @file FXAS21002C_ShmRing.cpp
+ *
+ * Shared memory sample bus for Linux.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_ShmRing.h"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/***************************************************************************
+ DESTRUCTOR
+ ***************************************************************************/
+
+FXAS21002C_ShmRing::~FXAS21002C_ShmRing() { end(); }
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Creates (or replaces) the ring as the writer. Only one process
+            may create and publish to a ring. Replacing a ring keeps its
+            shared memory object, never shrinks it and bumps its
+            generation, so readers still mapping it resync to the new
+            ring.
+    @param  name
+            POSIX shared memory name, e.g. "/fxas21002c"
+    @param  capacity
+            Number of slots, rounded down to a power of two
+    @param  period
+            Sample period in us, stored for readers
+    @return True if the ring was created and mapped
+*/
+/**************************************************************************/
+bool FXAS21002C_ShmRing::create(const char *name, uint32_t capacity,
+                                uint32_t period) {
+  end();
+  if (!capacity)
+    return false;
+
+  uint32_t slots = 1;
+  while ((slots << 1) && ((slots << 1) <= capacity))
+    slots <<= 1;
+
+  int fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+  if (fd < 0)
+    return false;
+
+  /* Readers of an existing ring may still map all of it, so only grow */
+  size_t size = sizeof(fxasShmHeader_t) + slots * sizeof(gyroSample_t);
+  struct stat st;
+  if ((fstat(fd, &st) < 0) ||
+      ((st.st_size < (off_t)size) && (ftruncate(fd, size) < 0)) ||
+      !map(fd, size, true)) {
+    close(fd);
+    return false;
+  }
+  close(fd);
+
+  /* The object may be an existing ring that readers still validate:
+   * withdraw its magic first and publish it last, so a reader never sees
+   * a half set up header. A new object reads as generation 0. */
+  __atomic_store_n(&_header->magic, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  _header->version = FXAS21002C_SHMRING_VERSION;
+  _header->capacity = slots;
+  _header->period = period;
+  __atomic_store_n(&_header->head, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&_header->generation, _header->generation + 1,
+                   __ATOMIC_RELAXED);
+  __atomic_store_n(&_header->magic, FXAS21002C_SHMRING_MAGIC, __ATOMIC_RELEASE);
+  _mask = slots - 1;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Maps an existing ring read-only as a reader. The cursor starts
+            at the newest sample, so only samples published after attach()
+            are returned. When the writer later re-creates the ring, the
+            reader follows it from its first sample.
+    @param  name
+            POSIX shared memory name the writer used
+    @return True if the ring exists and is valid
+*/
+/**************************************************************************/
+bool FXAS21002C_ShmRing::attach(const char *name) {
+  end();
+
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0)
+    return false;
+
+  /* Kept open to map the object again if a restarted writer grows it */
+  _fd = fd;
+  struct stat st;
+  if ((fstat(fd, &st) < 0) || (st.st_size < (off_t)sizeof(fxasShmHeader_t)) ||
+      !map(fd, st.st_size, false) || !sync()) {
+    end();
+    return false;
+  }
+
+  _cursor = __atomic_load_n(&_header->head, __ATOMIC_ACQUIRE);
+  if (!current()) {
+    end();
+    return false;
+  }
+  _restarts = 0;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Unmaps the ring. The shared memory object stays until unlink().
+*/
+/**************************************************************************/
+void FXAS21002C_ShmRing::end() {
+  if (_header)
+    munmap(_header, _size);
+  if (_fd >= 0)
+    close(_fd);
+  _fd = -1;
+  _header = NULL;
+  _slots = NULL;
+  _size = 0;
+  _mask = 0;
+  _generation = 0;
+  _cursor = 0;
+  _overruns = 0;
+  _restarts = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Removes the shared memory object; mapped readers keep their
+            mapping until they call end()
+    @param  name
+            POSIX shared memory name
+    @return True if it was removed
+*/
+/**************************************************************************/
+bool FXAS21002C_ShmRing::unlink(const char *name) {
+  return shm_unlink(name) == 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Publishes samples to all readers. Writer only.
+    @param  samples
+            Samples, oldest first
+    @param  count
+            Number of samples
+*/
+/**************************************************************************/
+void FXAS21002C_ShmRing::publish(const gyroSample_t *samples,
+                                 uint16_t count) {
+  if (!_header)
+    return;
+
+  uint32_t head = __atomic_load_n(&_header->head, __ATOMIC_RELAXED);
+  for (uint16_t i = 0; i < count; i++) {
+    _slots[(head + i) & _mask] = samples[i];
+    /* Each slot is published on its own, so a reader that checks head
+     * after copying can tell whether the slot was reused meanwhile. The
+     * fence keeps the next slot write behind this head update; without it
+     * the reuse could become visible before the head that announces it. */
+    __atomic_store_n(&_header->head, head + i + 1, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets this reader's next sample
+    @param[out] sample
+                The sample
+    @return True if a sample was available
+*/
+/**************************************************************************/
+bool FXAS21002C_ShmRing::read(gyroSample_t *sample) {
+  for (;;) {
+    if (!sync())
+      return false;
+    uint32_t head = __atomic_load_n(&_header->head, __ATOMIC_ACQUIRE);
+    if (head == _cursor)
+      return false;
+    /* The oldest slot of a full ring is the next one the writer fills,
+     * so a reader that fell behind resumes one slot later */
+    if (head - _cursor > _mask) {
+      _overruns += head - _cursor - _mask;
+      _cursor = head - _mask;
+    }
+
+    memcpy(sample, (const void *)&_slots[_cursor & _mask],
+           sizeof(gyroSample_t));
+
+    /* The writer may have been filling this slot with sample
+     * _cursor + capacity while it was copied; head tells, unless the
+     * writer restarted meanwhile, then sync() starts over */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (!current())
+      continue;
+    head = __atomic_load_n(&_header->head, __ATOMIC_RELAXED);
+    if (head - _cursor <= _mask) {
+      _cursor++;
+      return true;
+    }
+    _overruns++;
+    _cursor++;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of samples this reader has not read yet
+    @return The number of samples, at most the ring capacity minus one
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_ShmRing::available() {
+  if (!sync())
+    return 0;
+  uint32_t n = __atomic_load_n(&_header->head, __ATOMIC_ACQUIRE) - _cursor;
+  return n > _mask ? _mask : n;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of samples this reader lost by falling behind
+    @return The overrun count
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_ShmRing::overruns() { return _overruns; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of times this reader followed a restarted
+            writer. Samples before and after a restart are not contiguous.
+    @return The restart count
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_ShmRing::restarts() { return _restarts; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the sample period the writer stored
+    @return The period in us, 0 if unknown
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_ShmRing::period() {
+  return _header ? _header->period : 0;
+}
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Maps the shared memory object
+    @param  fd
+            The shared memory file descriptor
+    @param  size
+            Size of the object in bytes
+    @param  writable
+            True for the writer
+    @return True if it was mapped
+*/
+/**************************************************************************/
+bool FXAS21002C_ShmRing::map(int fd, size_t size, bool writable) {
+  void *p = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                 MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED)
+    return false;
+
+  _header = (fxasShmHeader_t *)p;
+  _slots = (gyroSample_t *)(_header + 1);
+  _size = size;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Makes a reader follow the writer's current generation. After a
+            restart the cursor moves to the new ring's first sample, and
+            the object is mapped again if the new ring outgrew the mapping.
+    @return False if there is no valid ring to read right now, e.g. while
+            the writer is re-creating it
+*/
+/**************************************************************************/
+bool FXAS21002C_ShmRing::sync() {
+  if (!_header)
+    return false;
+  if (__atomic_load_n(&_header->magic, __ATOMIC_ACQUIRE) !=
+      FXAS21002C_SHMRING_MAGIC)
+    return false;
+  uint32_t generation =
+      __atomic_load_n(&_header->generation, __ATOMIC_RELAXED);
+  if (generation == _generation)
+    return true;
+
+  uint32_t capacity = _header->capacity;
+  if ((_header->version != FXAS21002C_SHMRING_VERSION) || !capacity ||
+      (capacity & (capacity - 1)))
+    return false;
+
+  size_t size = sizeof(fxasShmHeader_t) + capacity * sizeof(gyroSample_t);
+  if (_size < size) {
+    struct stat st;
+    if ((fstat(_fd, &st) < 0) || (st.st_size < (off_t)size))
+      return false;
+    munmap(_header, _size);
+    _header = NULL;
+    if (!map(_fd, st.st_size, false))
+      return false;
+  }
+
+  /* A header that changed while it was read belongs to a writer that is
+   * restarting again; the next call picks up its final state */
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if ((__atomic_load_n(&_header->magic, __ATOMIC_RELAXED) !=
+       FXAS21002C_SHMRING_MAGIC) ||
+      (__atomic_load_n(&_header->generation, __ATOMIC_RELAXED) != generation))
+    return false;
+
+  if (_generation)
+    _restarts++;
+  _generation = generation;
+  _mask = capacity - 1;
+  _cursor = 0;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks that the writer has not restarted since sync(). Call it
+            after an acquire fence to validate data read from the ring.
+    @return True if the ring is still the one this reader follows
+*/
+/**************************************************************************/
+bool FXAS21002C_ShmRing::current() {
+  return (__atomic_load_n(&_header->magic, __ATOMIC_RELAXED) ==
+          FXAS21002C_SHMRING_MAGIC) &&
+         (__atomic_load_n(&_header->generation, __ATOMIC_RELAXED) ==
+          _generation);
+}
+
+#endif
@@ -0,0 +1,94 @@
+/*!
+ * @file FXAS21002C_ShmRing.h
+ *
+ * Shared memory sample bus for Linux: one acquisition process owns the
+ * sensor and publishes timestamped samples into a ring in /dev/shm, any
+ * number of reader processes map the same ring and follow it with their
+ * own cursor.
+ *
+ * extras/shmd/fxas21002c_shmd.cpp is the acquisition daemon: it runs the
+ * sensor on /dev/i2c-N through FXAS21002C_LinuxI2C, drains the FIFO and
+ * publishes every sample.
+ *
+ * A writer that restarts calls create() with the same name again, which
+ * reuses the object and bumps its generation; mapped readers notice and
+ * follow the new ring from its start. Unlinking the object instead
+ * strands the readers on the old one until they attach() again.
+ *
+ * This header has no Arduino dependencies, so readers build on their own.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_SHMRING_H__
+#define __FXAS21002C_SHMRING_H__
+
+#if defined(__linux__)
+
+#include "FXAS21002C_Types.h"
+
+/** Magic at the start of the shared memory object, "FXSR" */
+#define FXAS21002C_SHMRING_MAGIC (0x52535846UL)
+/** Layout version */
+#define FXAS21002C_SHMRING_VERSION (2)
+
+/*!
+    Header at the start of the shared memory object, followed by 'capacity'
+    gyroSample_t slots
+*/
+typedef struct fxasShmHeader_s {
+  uint32_t magic;      /**< FXAS21002C_SHMRING_MAGIC once initialised */
+  uint32_t version;    /**< FXAS21002C_SHMRING_VERSION */
+  uint32_t capacity;   /**< Number of slots, a power of two */
+  uint32_t period;     /**< Sample period in us, 0 if unknown */
+  uint32_t head;       /**< Number of samples published so far, wraps */
+  uint32_t generation; /**< Incremented by every create() */
+} fxasShmHeader_t;
+
+/**************************************************************************/
+/*!
+    @brief  Single writer, many reader broadcast ring in POSIX shared
+            memory. Readers never block or slow the writer: a reader that
+            falls 'capacity' samples behind skips to the oldest sample the
+            writer is not about to overwrite, keeping capacity - 1, and
+            counts the skipped samples as overruns. Readers map the ring
+            read-only and copy samples straight out of the writer's memory;
+            nothing is serialised or sent through a socket.
+*/
+/**************************************************************************/
+class FXAS21002C_ShmRing {
+public:
+  ~FXAS21002C_ShmRing();
+
+  bool create(const char *name, uint32_t capacity, uint32_t period = 0);
+  bool attach(const char *name);
+  void end();
+  static bool unlink(const char *name);
+
+  void publish(const gyroSample_t *samples, uint16_t count);
+
+  bool read(gyroSample_t *sample);
+  uint32_t available();
+  uint32_t overruns();
+  uint32_t restarts();
+  uint32_t period();
+
+private:
+  bool map(int fd, size_t size, bool writable);
+  bool sync();
+  bool current();
+
+  int _fd = -1;
+  fxasShmHeader_t *_header = NULL;
+  gyroSample_t *_slots = NULL;
+  size_t _size = 0;
+  uint32_t _mask = 0;
+  uint32_t _generation = 0; ///< Writer generation this reader follows
+  uint32_t _cursor = 0;     ///< Next sample this reader returns
+  uint32_t _overruns = 0;   ///< Samples this reader lost
+  uint32_t _restarts = 0;   ///< Writer restarts this reader followed
+};
+
+#endif
+
+#endif
@@ -0,0 +1,527 @@
+/*!
+ * @file FXAS21002C_Sim.cpp
+ *
+ * Register level software model of the FXAS21002C for host builds.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Sim.h"
+
+#ifdef FXAS21002C_HOST
+
+/* CTRL_REG1 */
+#define CTRL1_RST (0x40)    ///< Software reset
+#define CTRL1_ST (0x20)     ///< Self-test enable
+#define CTRL1_DR (0x1C)     ///< Output data rate
+#define CTRL1_ACTIVE (0x02) ///< Active mode
+#define CTRL1_READY (0x01)  ///< Ready mode, if ACTIVE is clear
+
+/* CTRL_REG2 */
+#define CTRL2_CFG_FIFO (0x80) ///< FIFO interrupt on INT1, else INT2
+#define CTRL2_EN_FIFO (0x40)  ///< FIFO interrupt enable
+#define CTRL2_CFG_DRDY (0x08) ///< Data ready interrupt on INT1, else INT2
+#define CTRL2_EN_DRDY (0x04)  ///< Data ready interrupt enable
+
+/* CTRL_REG3 */
+#define CTRL3_WRAPTOONE (0x08) ///< Auto-increment rolls over to OUT_X_MSB
+#define CTRL3_FS_DOUBLE (0x01) ///< Doubles the full scale range
+
+/* INT_SOURCE_FLAG */
+#define SRC_BOOTEND (0x08) ///< Boot sequence complete
+#define SRC_FIFO (0x04)    ///< FIFO watermark or overflow
+#define SRC_DRDY (0x01)    ///< Data ready
+
+/* DR_STATUS */
+#define DR_OVERWRITE (0xF0) ///< ZYXOW, ZOW, YOW, XOW
+#define DR_READY (0x0F)     ///< ZYXDR, ZDR, YDR, XDR
+
+/* F_STATUS */
+#define F_OVF (0x80)  ///< FIFO overflow
+#define F_WMKF (0x40) ///< FIFO watermark reached
+
+/** Sample period in us for each DR setting */
+static const uint32_t dr_period[8] = {1250,  2500,  5000,  10000,
+                                      20000, 40000, 80000, 80000};
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a powered up FXAS21002C in Standby mode at virtual
+            time 0
+*/
+/**************************************************************************/
+FXAS21002C_Sim::FXAS21002C_Sim() { reset(); }
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Burst read with the chip's auto-increment rules. OUT_Z_LSB
+            rolls over to STATUS, or to OUT_X_MSB with WRAPTOONE set; in
+            FIFO mode each pass over OUT_Z_LSB pops one sample.
+    @param  reg
+            The first register to read
+    @param  buffer
+            Receives the register contents
+    @param  len
+            Number of bytes to read
+    @return False if the transfer was made to fail with failTransfers()
+*/
+/**************************************************************************/
+bool FXAS21002C_Sim::readRegisters(uint8_t reg, uint8_t *buffer,
+                                   size_t len) {
+  if (_fail) {
+    _fail--;
+    busTime(3 + len);
+    return false;
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    buffer[i] = readByte(reg);
+    if (reg == GYRO_REGISTER_OUT_Z_LSB)
+      reg = (_regs[GYRO_REGISTER_CTRL_REG3] & CTRL3_WRAPTOONE)
+                ? GYRO_REGISTER_OUT_X_MSB
+                : GYRO_REGISTER_STATUS;
+    else
+      reg = (reg + 1) % FXAS21002C_SIM_REGISTERS;
+  }
+  busTime(3 + len);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Writes one register. Read-only registers, and CTRL_REG0,
+            CTRL_REG2, CTRL_REG3 and the CTRL_REG1 data rate while Active,
+            are left unchanged and counted in violations().
+    @param  reg
+            The register to write
+    @param  value
+            The new register value
+    @return False if the transfer was made to fail with failTransfers()
+*/
+/**************************************************************************/
+bool FXAS21002C_Sim::writeRegister(uint8_t reg, uint8_t value) {
+  /* The register changes at the end of the transfer, charge its time
+   * first */
+  busTime(3);
+  if (_fail) {
+    _fail--;
+    return false;
+  }
+  if (reg >= FXAS21002C_SIM_REGISTERS)
+    return false;
+
+  if (!writable(reg)) {
+    _violations++;
+    return true;
+  }
+
+  switch (reg) {
+  case GYRO_REGISTER_F_SETUP:
+    /* Changing the mode flushes the FIFO */
+    if ((value ^ _regs[reg]) & 0xC0) {
+      _fifoHead = 0;
+      _fifoCount = 0;
+      _overflow = false;
+    }
+    break;
+
+  case GYRO_REGISTER_CTRL_REG1:
+    if (value & CTRL1_RST) {
+      reset();
+      return true;
+    }
+    /* Mode and self-test may change at any time, DR only outside Active
+     * mode */
+    if (active() && ((value ^ _regs[reg]) & CTRL1_DR)) {
+      _violations++;
+      value = (value & ~CTRL1_DR) | (_regs[reg] & CTRL1_DR);
+    }
+    if (!active() && (value & CTRL1_ACTIVE)) {
+      uint32_t startUs = (_regs[reg] & CTRL1_READY)
+                             ? FXAS21002C_SIM_READY_TO_ACTIVE_US
+                             : FXAS21002C_SIM_STANDBY_TO_ACTIVE_US;
+      _regs[reg] = value;
+      _nextSample = _time + startUs + period();
+      return true;
+    }
+    break;
+  }
+
+  _regs[reg] = value;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the virtual time
+    @return Microseconds since the simulation started
+*/
+/**************************************************************************/
+uint64_t FXAS21002C_Sim::now() { return _time; }
+
+/**************************************************************************/
+/*!
+    @brief  Lets virtual time pass; the chip samples meanwhile
+    @param  us
+            Microseconds
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::sleep(uint32_t us) {
+  _time += us;
+  update();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets a constant angular rate
+    @param  x
+            X axis rate in dps
+    @param  y
+            Y axis rate in dps
+    @param  z
+            Z axis rate in dps
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::setRate(float x, float y, float z) {
+  _rate[0] = x;
+  _rate[1] = y;
+  _rate[2] = z;
+  _source = NULL;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets a time dependent angular rate, evaluated for every sample
+    @param  source
+            The rate function, NULL to return to the constant rate
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::setRateSource(fxas_sim_rate_t source) {
+  _source = source;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets the output noise, uniform and deterministic
+    @param  lsb
+            Largest deviation in LSB, 0 for none
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::setNoise(uint16_t lsb) { _noise = lsb; }
+
+/**************************************************************************/
+/*!
+    @brief  Sets the output change while the ST bit is set
+    @param  lsb
+            Deflection in LSB, added to every axis
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::setSelfTestResponse(int16_t lsb) { _selfTest = lsb; }
+
+/**************************************************************************/
+/*!
+    @brief  Sets the value of the TEMP register
+    @param  celsius
+            Die temperature in degrees C
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::setTemperature(int8_t celsius) {
+  _temperature = celsius;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Sets the I2C clock used to charge transfer time
+    @param  hz
+            Bus clock in Hz, 0 for transfers that take no time
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::setBusSpeed(uint32_t hz) { _busHz = hz; }
+
+/**************************************************************************/
+/*!
+    @brief  Makes the next transfers fail, as if the chip did not
+            acknowledge
+    @param  count
+            Number of transfers to fail
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::failTransfers(uint16_t count) { _fail = count; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets a register without the side effects of a bus read
+    @param  reg
+            The register
+    @return The stored register value, 0 outside the register map
+*/
+/**************************************************************************/
+uint8_t FXAS21002C_Sim::peek(uint8_t reg) {
+  return reg < FXAS21002C_SIM_REGISTERS ? _regs[reg] : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the state of an interrupt pin, regardless of IPOL
+    @param  pin
+            1 for INT1, 2 for INT2
+    @return True if an enabled interrupt source routed to the pin is set
+*/
+/**************************************************************************/
+bool FXAS21002C_Sim::interrupt(uint8_t pin) {
+  uint8_t ctrl = _regs[GYRO_REGISTER_CTRL_REG2];
+  uint8_t src = _regs[GYRO_REGISTER_INT_SRC_FLAG];
+  bool int1 = (pin == 1);
+
+  if ((src & SRC_FIFO) && (ctrl & CTRL2_EN_FIFO) &&
+      (((ctrl & CTRL2_CFG_FIFO) != 0) == int1))
+    return true;
+  return (src & SRC_DRDY) && (ctrl & CTRL2_EN_DRDY) &&
+         (((ctrl & CTRL2_CFG_DRDY) != 0) == int1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of samples the chip has taken
+    @return The sample count
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_Sim::samples() { return _samples; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of bus transfers, failed ones included
+    @return The transfer count
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_Sim::transfers() { return _transfers; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the number of register writes the datasheet does not allow
+    @return The violation count
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_Sim::violations() { return _violations; }
+
+/**************************************************************************/
+/*!
+    @brief  Resets all registers, as on power-up or a CTRL_REG1 RST write.
+            Time, rate, noise and the counters are kept.
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::reset() {
+  memset(_regs, 0, sizeof(_regs));
+  _regs[GYRO_REGISTER_WHO_AM_I] = FXAS21002C_ID;
+  _regs[GYRO_REGISTER_INT_SRC_FLAG] = SRC_BOOTEND;
+  memset(_out, 0, sizeof(_out));
+  _fifoHead = 0;
+  _fifoCount = 0;
+  _overflow = false;
+}
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Takes every sample that is due at the current time
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::update() {
+  while (active() && (_time >= _nextSample)) {
+    sample();
+    _nextSample += period();
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Takes one sample into the output registers and the FIFO
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::sample() {
+  float dps[3] = {_rate[0], _rate[1], _rate[2]};
+  if (_source)
+    _source(_nextSample, dps);
+
+  float fullScale = (float)(2000 >> (_regs[GYRO_REGISTER_CTRL_REG0] & 0x03));
+  if (_regs[GYRO_REGISTER_CTRL_REG3] & CTRL3_FS_DOUBLE)
+    fullScale *= 2;
+
+  for (uint8_t i = 0; i < 3; i++) {
+    float lsb = dps[i] * 32000.0F / fullScale;
+    if (_noise) {
+      /* xorshift32 */
+      _seed ^= _seed << 13;
+      _seed ^= _seed >> 17;
+      _seed ^= _seed << 5;
+      lsb += (float)(int32_t)(_seed % (2 * _noise + 1)) - _noise;
+    }
+    if (_regs[GYRO_REGISTER_CTRL_REG1] & CTRL1_ST)
+      lsb += _selfTest;
+    if (lsb > 32767)
+      lsb = 32767;
+    else if (lsb < -32768)
+      lsb = -32768;
+    _out[i] = (int16_t)lsb;
+  }
+  _samples++;
+
+  uint8_t &status = _regs[GYRO_REGISTER_DR_STATUS];
+  if (status & DR_READY)
+    status |= DR_OVERWRITE;
+  status |= DR_READY;
+  _regs[GYRO_REGISTER_INT_SRC_FLAG] |= SRC_DRDY;
+
+  uint8_t mode = _regs[GYRO_REGISTER_F_SETUP] >> 6;
+  if (mode == GYRO_FIFO_DISABLED)
+    return;
+
+  if (_fifoCount == FXAS21002C_FIFO_DEPTH) {
+    _overflow = true;
+    if (mode != GYRO_FIFO_CIRCULAR)
+      return;
+    _fifoHead = (_fifoHead + 1) % FXAS21002C_FIFO_DEPTH;
+    _fifoCount--;
+  }
+  uint8_t tail = (_fifoHead + _fifoCount) % FXAS21002C_FIFO_DEPTH;
+  memcpy(_fifo[tail], _out, sizeof(_out));
+  _fifoCount++;
+
+  uint8_t watermark = _regs[GYRO_REGISTER_F_SETUP] & 0x3F;
+  if (_overflow || (watermark && (_fifoCount >= watermark)))
+    _regs[GYRO_REGISTER_INT_SRC_FLAG] |= SRC_FIFO;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads one register with its read side effects
+    @param  reg
+            The register
+    @return The register value
+*/
+/**************************************************************************/
+uint8_t FXAS21002C_Sim::readByte(uint8_t reg) {
+  uint8_t mode = _regs[GYRO_REGISTER_F_SETUP] >> 6;
+  uint8_t watermark = _regs[GYRO_REGISTER_F_SETUP] & 0x3F;
+  uint8_t fifoStatus = (_overflow ? F_OVF : 0) |
+                       ((watermark && (_fifoCount >= watermark)) ? F_WMKF : 0) |
+                       _fifoCount;
+
+  switch (reg) {
+  case GYRO_REGISTER_STATUS:
+    return mode ? fifoStatus : _regs[GYRO_REGISTER_DR_STATUS];
+
+  case GYRO_REGISTER_OUT_X_MSB:
+  case GYRO_REGISTER_OUT_X_LSB:
+  case GYRO_REGISTER_OUT_Y_MSB:
+  case GYRO_REGISTER_OUT_Y_LSB:
+  case GYRO_REGISTER_OUT_Z_MSB:
+  case GYRO_REGISTER_OUT_Z_LSB: {
+    /* In FIFO mode the output registers show the oldest FIFO entry */
+    const int16_t *data = (mode && _fifoCount) ? _fifo[_fifoHead] : _out;
+    uint16_t value = (uint16_t)data[(reg - 1) / 2];
+    uint8_t byte = (reg & 1) ? (value >> 8) : (value & 0xFF);
+
+    if (reg == GYRO_REGISTER_OUT_Z_LSB) {
+      if (mode && _fifoCount) {
+        memcpy(_out, _fifo[_fifoHead], sizeof(_out));
+        _fifoHead = (_fifoHead + 1) % FXAS21002C_FIFO_DEPTH;
+        _fifoCount--;
+      } else if (!mode) {
+        _regs[GYRO_REGISTER_DR_STATUS] = 0;
+        _regs[GYRO_REGISTER_INT_SRC_FLAG] &= ~SRC_DRDY;
+      }
+    }
+    return byte;
+  }
+
+  case GYRO_REGISTER_F_STATUS:
+    /* Reading F_STATUS acknowledges the FIFO interrupt */
+    _overflow = false;
+    _regs[GYRO_REGISTER_INT_SRC_FLAG] &= ~SRC_FIFO;
+    return fifoStatus;
+
+  case GYRO_REGISTER_TEMP:
+    return (uint8_t)_temperature;
+
+  default:
+    return _regs[reg];
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks whether the chip is in Active mode
+    @return True if Active
+*/
+/**************************************************************************/
+bool FXAS21002C_Sim::active() {
+  return _regs[GYRO_REGISTER_CTRL_REG1] & CTRL1_ACTIVE;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks a register write against the datasheet's rules
+    @param  reg
+            The register
+    @return False if the chip ignores the write
+*/
+/**************************************************************************/
+bool FXAS21002C_Sim::writable(uint8_t reg) {
+  switch (reg) {
+  case GYRO_REGISTER_F_SETUP:
+  case GYRO_REGISTER_CTRL_REG1:
+  case GYRO_REGISTER_RT_CFG:
+  case GYRO_REGISTER_RT_THS:
+  case GYRO_REGISTER_RT_COUNT:
+    return true;
+
+  case GYRO_REGISTER_CTRL_REG0:
+  case GYRO_REGISTER_CTRL_REG2:
+  case GYRO_REGISTER_CTRL_REG3:
+    return !active();
+
+  default:
+    return false;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the sample period of the configured data rate
+    @return The period in us
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_Sim::period() {
+  return dr_period[(_regs[GYRO_REGISTER_CTRL_REG1] & CTRL1_DR) >> 2];
+}
+
+/**************************************************************************/
+/*!
+    @brief  Charges the time a transfer takes on the bus and takes the
+            samples that fall due meanwhile. Reads are charged after the
+            data is taken, so the FIFO drains as on the chip: samples
+            arriving during a burst land behind it.
+    @param  bytes
+            Bytes on the bus, address bytes included
+*/
+/**************************************************************************/
+void FXAS21002C_Sim::busTime(size_t bytes) {
+  _transfers++;
+  if (_busHz)
+    _time += (uint64_t)bytes * 9 * 1000000 / _busHz;
+  update();
+}
+
+#endif
@@ -0,0 +1,117 @@
+/*!
+ * @file FXAS21002C_Sim.h
+ *
+ * Register level software model of the FXAS21002C for host builds. It is
+ * both the transport the driver talks to and the clock behind millis(),
+ * micros() and delay(), so every driver path runs deterministically on
+ * virtual time, far faster than real time:
+ *
+ *   FXAS21002C_Sim sim;
+ *   FXAS21002C_Clock::set(&sim);
+ *   Adafruit_FXAS21002C gyro;
+ *   gyro.begin(sim);
+ *   sim.setRate(10, 0, -5);
+ *   delay(50);
+ *   gyro.readFIFO(...);
+ *
+ * Modelled: the register map and reset values, Standby/Ready/Active modes
+ * and their start-up times, ODR timed sampling with full scale and
+ * FS_DOUBLE, DR_STATUS data ready and overwrite flags, the 32 sample FIFO
+ * in circular and stop mode with watermark and overflow, the auto-
+ * increment roll-over (WRAPTOONE), self-test deflection, TEMP, and the
+ * data ready and FIFO interrupt sources and pin routing. Writes that the
+ * datasheet only allows outside Active mode are ignored and counted, so a
+ * test can assert that the driver never makes one. The rate threshold
+ * engine is not modelled; its registers only store values.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_SIM_H__
+#define __FXAS21002C_SIM_H__
+
+#include "Adafruit_FXAS21002C.h"
+
+#ifdef FXAS21002C_HOST
+
+#include "FXAS21002C_Transport.h"
+
+/** Standby to Active start-up time in us, plus one sample period */
+#define FXAS21002C_SIM_STANDBY_TO_ACTIVE_US (60000)
+/** Ready to Active start-up time in us, plus one sample period */
+#define FXAS21002C_SIM_READY_TO_ACTIVE_US (5000)
+/** Number of registers in the model, 0x00 to 0x15 */
+#define FXAS21002C_SIM_REGISTERS (0x16)
+
+/** Angular rate source: fills dps[3] with the rate at virtual time 'us' */
+typedef void (*fxas_sim_rate_t)(uint64_t us, float *dps);
+
+/**************************************************************************/
+/*!
+    @brief  Simulated FXAS21002C. Pass it to begin(FXAS21002C_Transport &)
+            and install it with FXAS21002C_Clock::set() so delays in the
+            driver let virtual time pass. Every transfer also takes the
+            time it would take on the bus, 400 kHz by default.
+*/
+/**************************************************************************/
+class FXAS21002C_Sim : public FXAS21002C_Transport, public FXAS21002C_Clock {
+public:
+  FXAS21002C_Sim();
+
+  bool readRegisters(uint8_t reg, uint8_t *buffer, size_t len);
+  bool writeRegister(uint8_t reg, uint8_t value);
+
+  uint64_t now();
+  void sleep(uint32_t us);
+
+  void setRate(float x, float y, float z);
+  void setRateSource(fxas_sim_rate_t source);
+  void setNoise(uint16_t lsb);
+  void setSelfTestResponse(int16_t lsb);
+  void setTemperature(int8_t celsius);
+  void setBusSpeed(uint32_t hz);
+  void failTransfers(uint16_t count);
+
+  uint8_t peek(uint8_t reg);
+  bool interrupt(uint8_t pin);
+  uint32_t samples();
+  uint32_t transfers();
+  uint32_t violations();
+  void reset();
+
+private:
+  void update();
+  void sample();
+  uint8_t readByte(uint8_t reg);
+  bool active();
+  bool writable(uint8_t reg);
+  uint32_t period();
+  void busTime(size_t bytes);
+
+  uint8_t _regs[FXAS21002C_SIM_REGISTERS];
+  int16_t _out[3];                         ///< Latest sample, OUT registers
+  int16_t _fifo[FXAS21002C_FIFO_DEPTH][3]; ///< FIFO, oldest at _fifoHead
+  uint8_t _fifoHead = 0;
+  uint8_t _fifoCount = 0;
+  bool _overflow = false; ///< F_OVF, cleared by reading F_STATUS
+
+  uint64_t _time = 0;       ///< Virtual time in us
+  uint64_t _nextSample = 0; ///< Time of the next sample while Active
+  uint32_t _busHz = 400000;
+  uint16_t _fail = 0; ///< Transfers still to fail
+
+  float _rate[3] = {0, 0, 0}; ///< Constant rate in dps
+  fxas_sim_rate_t _source = NULL;
+  uint16_t _noise = 0;
+  int16_t _selfTest = 8000;
+  int8_t _temperature = 25;
+  uint32_t _seed = 1; ///< Noise generator state
+
+  uint32_t _samples = 0;
+  uint32_t _transfers = 0;
+  uint32_t _violations = 0;
+};
+
+#endif
+
+#endif
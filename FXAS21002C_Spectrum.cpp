@@ -0,0 +1,343 @@
+/*!
+ * @file FXAS21002C_Spectrum.cpp
+ *
+ * Streaming Welch power spectral density estimator for blocks of raw
+ * FXAS21002C samples. On MCUs without an FPU the FFT runs in Q15 fixed
+ * point with a 1/2 scale per butterfly stage, so it can never overflow.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Spectrum.h"
+#include <math.h>
+
+#define FFT_N (FXAS21002C_FFT_SIZE)     ///< Real FFT length
+#define FFT_M (FXAS21002C_FFT_SIZE / 2) ///< Complex FFT length
+
+#if FXAS21002C_SPECTRUM_FLOAT
+static inline fxas_fft_t fftFromFloat(float v) { return v; }
+static inline fxas_fft_acc_t fftMul(fxas_fft_t a, fxas_fft_t b) {
+  return a * b;
+}
+static inline fxas_fft_t fftHalf(fxas_fft_acc_t v) { return v * 0.5F; }
+static inline fxas_fft_t fftWindow(fxas_fft_t c) { return 0.5F * (1.0F - c); }
+static const fxas_fft_t FFT_MINUS_ONE = -1.0F;
+#else
+static inline fxas_fft_t fftFromFloat(float v) {
+  return (fxas_fft_t)(v * 32767.0F + (v < 0 ? -0.5F : 0.5F));
+}
+static inline fxas_fft_acc_t fftMul(fxas_fft_t a, fxas_fft_t b) {
+  return ((int32_t)a * b) >> 15;
+}
+static inline fxas_fft_t fftHalf(fxas_fft_acc_t v) {
+  return (fxas_fft_t)(v >> 1);
+}
+static inline fxas_fft_t fftWindow(fxas_fft_t c) {
+  return (fxas_fft_t)((32767 - (int32_t)c) >> 1);
+}
+static const fxas_fft_t FFT_MINUS_ONE = -32767;
+#endif
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a new FXAS21002C_Spectrum class
+*/
+/**************************************************************************/
+FXAS21002C_Spectrum::FXAS21002C_Spectrum() {
+  _sampleRate = GYRO_ODR_100HZ;
+  _averages = 1;
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Builds the twiddle tables and clears all accumulated state
+    @param  sampleRate
+            The sample rate of the data in Hz, normally getODR()
+    @param  averages
+            The number of segments averaged into each published spectrum
+*/
+/**************************************************************************/
+void FXAS21002C_Spectrum::begin(float sampleRate, uint16_t averages) {
+  _sampleRate = sampleRate;
+  _averages = averages ? averages : 1;
+
+  /* W_N^k = cos(2*pi*k/N) - j*sin(2*pi*k/N), k < N/2 */
+  for (uint16_t k = 0; k < FFT_M; k++) {
+    float angle = 2.0F * (float)M_PI * k / FFT_N;
+    _cos[k] = fftFromFloat(cosf(angle));
+    _sin[k] = fftFromFloat(sinf(angle));
+  }
+
+  reset();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Discards buffered samples, accumulated power and peak history
+*/
+/**************************************************************************/
+void FXAS21002C_Spectrum::reset() {
+  _fill = 0;
+  _segments = 0;
+  _ready = false;
+  memset(_power, 0, sizeof(_power));
+  memset(_peak, 0, sizeof(_peak));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Feeds a block of raw samples, for example a FIFO drain
+    @param  samples
+            Pointer to the raw samples
+    @param  count
+            The number of samples
+    @return True if a new averaged spectrum completed during this call
+*/
+/**************************************************************************/
+bool FXAS21002C_Spectrum::addSamples(const gyroRawData_t *samples,
+                                     uint16_t count) {
+  bool completed = false;
+
+  for (uint16_t i = 0; i < count; i++) {
+    _frame[0][_fill] = samples[i].x;
+    _frame[1][_fill] = samples[i].y;
+    _frame[2][_fill] = samples[i].z;
+
+    if (++_fill < FFT_N)
+      continue;
+
+    processSegment();
+    completed |= _ready;
+
+    /* Keep the second half for the 50% overlap of the next segment */
+    for (uint8_t axis = 0; axis < 3; axis++) {
+      memmove(_frame[axis], &_frame[axis][FFT_M], FFT_M * sizeof(int16_t));
+    }
+    _fill = FFT_M;
+  }
+
+  return completed;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks whether an averaged spectrum is available. It remains
+            valid until the next segment after it is processed.
+    @return True if getSpectrum() and getPeak() hold a complete average
+*/
+/**************************************************************************/
+bool FXAS21002C_Spectrum::available() { return _ready; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the averaged one-sided power spectral density of one axis
+    @param  axis
+            0 for X, 1 for Y, 2 for Z
+    @param[out] psd
+            Array of FXAS21002C_SPECTRUM_BINS values in LSB^2/Hz. Multiply
+            by the squared sensitivity to get dps^2/Hz.
+*/
+/**************************************************************************/
+void FXAS21002C_Spectrum::getSpectrum(uint8_t axis, float *psd) {
+  /* |X|^2 / (fs * sum(w^2)), sum(w^2) = 3N/8 for a Hann window. The FFT
+   * output is scaled by 1/N, hence N^2 in the numerator. */
+  float scale = 0;
+  if (_segments)
+    scale = 8.0F * FFT_N / (3.0F * _sampleRate * _segments);
+
+  for (uint16_t k = 0; k < FXAS21002C_SPECTRUM_BINS; k++) {
+    psd[k] = _power[axis][k] * scale;
+    /* One-sided: fold the negative frequencies into all but DC/Nyquist */
+    if ((k != 0) && (k != FFT_M))
+      psd[k] *= 2.0F;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the tracked dominant peak of one axis. DC and the first
+            bin, which carries the window's DC leakage, are ignored.
+    @param  axis
+            0 for X, 1 for Y, 2 for Z
+    @return The tracked peak, updated with every averaged spectrum
+*/
+/**************************************************************************/
+gyroSpectrumPeak_t FXAS21002C_Spectrum::getPeak(uint8_t axis) {
+  return _peak[axis];
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the centre frequency of a spectrum bin
+    @param  bin
+            The bin index, 0 to FXAS21002C_SPECTRUM_BINS - 1
+    @return The frequency in Hz
+*/
+/**************************************************************************/
+float FXAS21002C_Spectrum::binFrequency(uint16_t bin) {
+  return bin * _sampleRate / FFT_N;
+}
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Transforms and accumulates one full segment on every axis
+*/
+/**************************************************************************/
+void FXAS21002C_Spectrum::processSegment() {
+  /* Start a new average once the previous one has been published */
+  if (_ready) {
+    memset(_power, 0, sizeof(_power));
+    _segments = 0;
+    _ready = false;
+  }
+
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    transform(_frame[axis]);
+    accumulate(axis);
+  }
+
+  if (++_segments >= _averages) {
+    _ready = true;
+    for (uint8_t axis = 0; axis < 3; axis++) {
+      trackPeak(axis);
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Windows a real segment, packs even/odd samples into the real and
+            imaginary parts of an N/2 point complex sequence and runs an in
+            place radix-2 decimation in time FFT on it. Both the input and
+            every stage are scaled by 1/2, so the result is X/N.
+    @param  in
+            FXAS21002C_FFT_SIZE raw samples
+*/
+/**************************************************************************/
+void FXAS21002C_Spectrum::transform(const int16_t *in) {
+  for (uint16_t m = 0; m < FFT_M; m++) {
+    uint16_t n0 = 2 * m, n1 = 2 * m + 1;
+    /* Periodic Hann window from the cosine table, symmetric about N/2 */
+    fxas_fft_t w0 = (n0 == FFT_M) ? fftWindow(FFT_MINUS_ONE)
+                    : fftWindow(n0 < FFT_M ? _cos[n0] : _cos[FFT_N - n0]);
+    fxas_fft_t w1 = fftWindow(n1 < FFT_M ? _cos[n1] : _cos[FFT_N - n1]);
+    _re[m] = fftHalf(fftMul((fxas_fft_t)in[n0], w0));
+    _im[m] = fftHalf(fftMul((fxas_fft_t)in[n1], w1));
+  }
+
+  /* Bit reversal permutation */
+  for (uint16_t i = 1, j = 0; i < FFT_M; i++) {
+    uint16_t bit = FFT_M >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      fxas_fft_t t = _re[i];
+      _re[i] = _re[j];
+      _re[j] = t;
+      t = _im[i];
+      _im[i] = _im[j];
+      _im[j] = t;
+    }
+  }
+
+  /* Butterflies, W_len^k = W_N^(k * N / len) */
+  for (uint16_t len = 2; len <= FFT_M; len <<= 1) {
+    uint16_t half = len >> 1;
+    uint16_t step = FFT_N / len;
+    for (uint16_t i = 0; i < FFT_M; i += len) {
+      for (uint16_t k = 0; k < half; k++) {
+        fxas_fft_t wr = _cos[k * step];
+        fxas_fft_t wi = _sin[k * step];
+        uint16_t a = i + k, b = a + half;
+        /* (re + j*im) * (wr - j*wi) */
+        fxas_fft_acc_t tr = fftMul(_re[b], wr) + fftMul(_im[b], wi);
+        fxas_fft_acc_t ti = fftMul(_im[b], wr) - fftMul(_re[b], wi);
+        _re[b] = fftHalf(_re[a] - tr);
+        _im[b] = fftHalf(_im[a] - ti);
+        _re[a] = fftHalf(_re[a] + tr);
+        _im[a] = fftHalf(_im[a] + ti);
+      }
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Splits the packed complex FFT into the real FFT bins and adds
+            their power to the running sums of one axis
+    @param  axis
+            0 for X, 1 for Y, 2 for Z
+*/
+/**************************************************************************/
+void FXAS21002C_Spectrum::accumulate(uint8_t axis) {
+  for (uint16_t k = 0; k <= FFT_M; k++) {
+    uint16_t a = (k == FFT_M) ? 0 : k;
+    uint16_t b = (k == 0) ? 0 : FFT_M - k;
+
+    /* Even part E = (Z[k] + Z*[M-k]) / 2, odd part O = -j(Z[k] - Z*[M-k])/2 */
+    fxas_fft_t er = fftHalf((fxas_fft_acc_t)_re[a] + _re[b]);
+    fxas_fft_t ei = fftHalf((fxas_fft_acc_t)_im[a] - _im[b]);
+    fxas_fft_t orr = fftHalf((fxas_fft_acc_t)_im[a] + _im[b]);
+    fxas_fft_t oi = fftHalf((fxas_fft_acc_t)_re[b] - _re[a]);
+
+    /* X[k] = E + W_N^k * O */
+    fxas_fft_t c = (k == FFT_M) ? FFT_MINUS_ONE : _cos[k];
+    fxas_fft_t s = (k == FFT_M) ? 0 : _sin[k];
+    float xr = (float)(er + fftMul(c, orr) + fftMul(s, oi));
+    float xi = (float)(ei + fftMul(c, oi) - fftMul(s, orr));
+
+    _power[axis][k] += xr * xr + xi * xi;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Locates the strongest bin of a completed average, refines it by
+            parabolic interpolation and updates the tracked peak
+    @param  axis
+            0 for X, 1 for Y, 2 for Z
+*/
+/**************************************************************************/
+void FXAS21002C_Spectrum::trackPeak(uint8_t axis) {
+  const float *p = _power[axis];
+  uint16_t best = 2;
+  for (uint16_t k = 3; k <= FFT_M; k++) {
+    if (p[k] > p[best])
+      best = k;
+  }
+
+  float offset = 0;
+  if (best < FFT_M) {
+    float denom = p[best - 1] - 2.0F * p[best] + p[best + 1];
+    if (denom != 0)
+      offset = 0.5F * (p[best - 1] - p[best + 1]) / denom;
+  }
+
+  float frequency = binFrequency(best) + offset * binFrequency(1);
+
+  /* Smooth the frequency while the peak stays within two bins, otherwise
+   * follow the new peak straight away */
+  gyroSpectrumPeak_t *peak = &_peak[axis];
+  if ((peak->power > 0) &&
+      (fabsf(frequency - peak->frequency) <= 2.0F * binFrequency(1))) {
+    peak->frequency += 0.25F * (frequency - peak->frequency);
+  } else {
+    peak->frequency = frequency;
+  }
+  peak->power = p[best] * 8.0F * FFT_N / (3.0F * _sampleRate * _segments);
+  if (best != FFT_M)
+    peak->power *= 2.0F;
+}
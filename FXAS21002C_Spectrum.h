@@ -0,0 +1,91 @@
+/*!
+ * @file FXAS21002C_Spectrum.h
+ *
+ * Streaming Welch power spectral density estimator for blocks of raw
+ * FXAS21002C samples, for on-device vibration monitoring.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_SPECTRUM_H__
+#define __FXAS21002C_SPECTRUM_H__
+
+#include "Adafruit_FXAS21002C.h"
+
+/*=========================================================================
+    SPECTRUM SETTINGS
+    -----------------------------------------------------------------------*/
+#ifndef FXAS21002C_FFT_SIZE
+/** FFT length in samples per segment, must be a power of two */
+#define FXAS21002C_FFT_SIZE (64)
+#endif
+/** Number of one-sided spectrum bins, DC through Nyquist */
+#define FXAS21002C_SPECTRUM_BINS (FXAS21002C_FFT_SIZE / 2 + 1)
+
+#ifndef FXAS21002C_SPECTRUM_FLOAT
+#if !defined(ARDUINO) || defined(__ARM_FP)
+/** Use the floating point FFT on hosts and MCUs with an FPU */
+#define FXAS21002C_SPECTRUM_FLOAT (1)
+#else
+/** Use the Q15 fixed-point FFT everywhere else */
+#define FXAS21002C_SPECTRUM_FLOAT (0)
+#endif
+#endif
+
+#if FXAS21002C_SPECTRUM_FLOAT
+typedef float fxas_fft_t;     /**< FFT sample type */
+typedef float fxas_fft_acc_t; /**< FFT intermediate product type */
+#else
+typedef int16_t fxas_fft_t;     /**< FFT sample type (Q15) */
+typedef int32_t fxas_fft_acc_t; /**< FFT intermediate product type */
+#endif
+/*=========================================================================*/
+
+/*!
+    Struct to store the dominant spectral peak of one axis
+*/
+typedef struct gyroSpectrumPeak_s {
+  float frequency; /**< Peak frequency in Hz, interpolated between bins */
+  float power;     /**< Power spectral density at the peak in LSB^2/Hz */
+} gyroSpectrumPeak_t;
+
+/**************************************************************************/
+/*!
+    @brief  Welch PSD estimator for the X, Y and Z axes. Samples are split
+            into 50% overlapping Hann windowed segments of
+            FXAS21002C_FFT_SIZE samples, each transformed with a radix-2
+            real FFT, and the segment powers are averaged.
+*/
+/**************************************************************************/
+class FXAS21002C_Spectrum {
+public:
+  FXAS21002C_Spectrum();
+  void begin(float sampleRate, uint16_t averages = 8);
+  void reset();
+  bool addSamples(const gyroRawData_t *samples, uint16_t count);
+  bool available();
+  void getSpectrum(uint8_t axis, float *psd);
+  gyroSpectrumPeak_t getPeak(uint8_t axis);
+  float binFrequency(uint16_t bin);
+
+private:
+  void processSegment();
+  void transform(const int16_t *in);
+  void accumulate(uint8_t axis);
+  void trackPeak(uint8_t axis);
+
+  float _sampleRate;
+  uint16_t _averages;
+  uint16_t _segments;
+  uint16_t _fill;
+  bool _ready;
+  int16_t _frame[3][FXAS21002C_FFT_SIZE];
+  fxas_fft_t _re[FXAS21002C_FFT_SIZE / 2];
+  fxas_fft_t _im[FXAS21002C_FFT_SIZE / 2];
+  fxas_fft_t _cos[FXAS21002C_FFT_SIZE / 2];
+  fxas_fft_t _sin[FXAS21002C_FFT_SIZE / 2];
+  float _power[3][FXAS21002C_SPECTRUM_BINS];
+  gyroSpectrumPeak_t _peak[3];
+};
+
+#endif
@@ -0,0 +1,287 @@
+/*!
+ * @file FXAS21002C_Stream.cpp
+ *
+ * Binary streaming format for sending raw FXAS21002C samples over a serial
+ * link.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Stream.h"
+#include <string.h>
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+static void putU16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void putU32(uint8_t *p, uint32_t v) {
+  putU16(p, v & 0xFFFF);
+  putU16(p + 2, v >> 16);
+}
+
+static uint16_t getU16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static uint32_t getU32(const uint8_t *p) {
+  return getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+/* COBS replaces every 0x00 with the distance to the next one, so 0x00 only
+ * ever appears as the frame delimiter */
+static size_t cobsEncode(const uint8_t *in, size_t len, uint8_t *out) {
+  size_t code = 0, pos = 1;
+  out[0] = 1;
+  for (size_t i = 0; i < len; i++) {
+    if (in[i]) {
+      out[pos++] = in[i];
+      out[code]++;
+    }
+    if (!in[i] || (out[code] == 0xFF)) {
+      code = pos++;
+      out[code] = 1;
+    }
+  }
+  return pos;
+}
+
+static size_t cobsDecode(uint8_t *buf, size_t len) {
+  size_t in = 0, out = 0;
+  while (in < len) {
+    uint8_t code = buf[in++];
+    if (!code || (in + code - 1 > len))
+      return 0;
+    for (uint8_t i = 1; i < code; i++)
+      buf[out++] = buf[in++];
+    if ((code != 0xFF) && (in < len))
+      buf[out++] = 0;
+  }
+  return out;
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Encodes samples as one frame, including the 0x00 delimiter
+    @param  samples
+            The raw samples, oldest first
+    @param  count
+            Number of samples, 1 to FXAS21002C_STREAM_MAX_SAMPLES
+    @param  timestamp
+            Time of the first sample in microseconds
+    @param  period
+            Sample period in microseconds
+    @param[out] out
+            Destination buffer, FXAS21002C_STREAM_MAX_FRAME(count) bytes
+            always suffice
+    @param  outSize
+            Size of 'out' in bytes
+    @return The number of bytes to send, 0 if 'count' is out of range or
+            'out' was too small
+*/
+/**************************************************************************/
+size_t FXAS21002C_Stream::encode(const gyroRawData_t *samples, uint8_t count,
+                                 uint32_t timestamp, uint32_t period,
+                                 uint8_t *out, size_t outSize) {
+  if (!count || (count > FXAS21002C_STREAM_MAX_SAMPLES) ||
+      (outSize < (size_t)FXAS21002C_STREAM_MAX_FRAME(count)))
+    return 0;
+
+  uint8_t frame[FXAS21002C_STREAM_OVERHEAD + FXAS21002C_STREAM_MAX_SAMPLES * 6];
+  size_t len = 0;
+  frame[len++] = _seq++;
+  frame[len++] = count;
+  putU32(frame + len, timestamp);
+  len += 4;
+  while (period >= 0x80) {
+    frame[len++] = (period & 0x7F) | 0x80;
+    period >>= 7;
+  }
+  frame[len++] = period;
+  for (uint8_t i = 0; i < count; i++) {
+    putU16(frame + len, samples[i].x);
+    putU16(frame + len + 2, samples[i].y);
+    putU16(frame + len + 4, samples[i].z);
+    len += 6;
+  }
+  putU16(frame + len, crc16(frame, len));
+  len += 2;
+
+  size_t n = cobsEncode(frame, len, out);
+  out[n++] = 0x00;
+  return n;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Computes a CRC-16/CCITT-FALSE (polynomial 0x1021, initial value
+            0xFFFF), bitwise so it needs no table
+    @param  data
+            The bytes to check
+    @param  len
+            Number of bytes
+    @return The CRC
+*/
+/**************************************************************************/
+uint16_t FXAS21002C_Stream::crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Feeds one received byte to the decoder
+    @param  c
+            The byte
+    @return True if it completed a valid frame, whose samples can then be
+            fetched with getSamples()
+*/
+/**************************************************************************/
+bool FXAS21002C_StreamDecoder::push(uint8_t c) {
+  if (c) {
+    if (_len < sizeof(_buffer))
+      _buffer[_len++] = c;
+    else
+      _overflow = true;
+    return false;
+  }
+
+  bool ok = false;
+  if (_overflow)
+    _stats.framingErrors++;
+  else if (_len)
+    ok = decodeFrame();
+  _len = 0;
+  _overflow = false;
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the samples of the last frame, if it was valid. They stay
+            available while the bytes of the next frame arrive.
+    @param[out] out
+                Receives the timestamped samples, room for
+                FXAS21002C_STREAM_MAX_SAMPLES always suffices
+    @return The number of samples, 0 if the last frame was invalid
+*/
+/**************************************************************************/
+uint8_t FXAS21002C_StreamDecoder::getSamples(gyroSample_t *out) {
+  if (!_valid)
+    return 0;
+
+  for (uint8_t i = 0; i < _count; i++) {
+    out[i].timestamp = _timestamp + i * _period;
+    out[i].data = _samples[i];
+  }
+  return _count;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the link statistics
+    @return The counters since the last reset()
+*/
+/**************************************************************************/
+const fxasStreamStats_t *FXAS21002C_StreamDecoder::getStats() {
+  return &_stats;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Drops any partial frame and clears the statistics
+*/
+/**************************************************************************/
+void FXAS21002C_StreamDecoder::reset() {
+  _len = 0;
+  _overflow = false;
+  _valid = false;
+  _count = 0;
+  _synced = false;
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Checks and parses the frame in _buffer, unpacks its samples
+            and accounts for frames and samples missing since the previous
+            one
+    @return True if the frame was valid
+*/
+/**************************************************************************/
+bool FXAS21002C_StreamDecoder::decodeFrame() {
+  _valid = false;
+
+  size_t len = cobsDecode(_buffer, _len);
+  if (len < 2 + 4 + 1 + 6 + 2) {
+    _stats.framingErrors++;
+    return false;
+  }
+  if (FXAS21002C_Stream::crc16(_buffer, len - 2) != getU16(_buffer + len - 2)) {
+    _stats.crcErrors++;
+    return false;
+  }
+
+  uint8_t seq = _buffer[0];
+  uint8_t count = _buffer[1];
+  uint32_t timestamp = getU32(_buffer + 2);
+  uint32_t period = 0;
+  size_t pos = 6;
+  for (uint8_t shift = 0;; shift += 7) {
+    if ((pos >= len) || (shift > 28)) {
+      _stats.framingErrors++;
+      return false;
+    }
+    uint8_t b = _buffer[pos++];
+    period |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80))
+      break;
+  }
+  if (!count || (count > FXAS21002C_STREAM_MAX_SAMPLES) ||
+      (pos + count * 6 + 2 != len)) {
+    _stats.framingErrors++;
+    return false;
+  }
+
+  if (_synced) {
+    _stats.lostFrames += (uint8_t)(seq - _seq - 1);
+    /* Samples are missing if this frame starts later than the previous
+     * one ended; rounding absorbs timestamp jitter */
+    uint32_t expected = _timestamp + _count * _period;
+    int32_t gap = (int32_t)(timestamp - expected);
+    if (period && (gap > (int32_t)(period / 2)))
+      _stats.lostSamples += (gap + period / 2) / period;
+  }
+
+  const uint8_t *p = _buffer + pos;
+  for (uint8_t i = 0; i < count; i++) {
+    _samples[i].x = (int16_t)getU16(p);
+    _samples[i].y = (int16_t)getU16(p + 2);
+    _samples[i].z = (int16_t)getU16(p + 4);
+    p += 6;
+  }
+  _valid = true;
+  _count = count;
+  _seq = seq;
+  _timestamp = timestamp;
+  _period = period;
+  _synced = true;
+  _stats.frames++;
+  _stats.samples += count;
+  return true;
+}
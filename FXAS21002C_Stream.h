@@ -0,0 +1,104 @@
+/*!
+ * @file FXAS21002C_Stream.h
+ *
+ * Binary streaming format for sending raw FXAS21002C samples over a serial
+ * link. Each frame is COBS encoded and terminated by a 0x00 byte; before
+ * encoding it holds, little endian:
+ *
+ *   uint8_t  seq         frame sequence number, wraps
+ *   uint8_t  count       number of samples, 1 to FXAS21002C_STREAM_MAX_SAMPLES
+ *   uint32_t timestamp   time of the first sample in microseconds
+ *   varint   period      LEB128 sample period in microseconds
+ *   int16_t  x, y, z     'count' raw samples, oldest first
+ *   uint16_t crc         CRC-16/CCITT-FALSE of all bytes before it
+ *
+ * Sample n of a frame was taken at timestamp + n * period. At 800 Hz a
+ * full FIFO drain of 32 samples is 204 bytes on the wire, so all three axes
+ * need about 5.1 kB/s and fit a 115200 baud UART (11.5 kB/s); frames of 8
+ * samples need 6 kB/s.
+ *
+ * Neither side has Arduino dependencies, so the decoder builds as-is on a
+ * host.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_STREAM_H__
+#define __FXAS21002C_STREAM_H__
+
+#include "FXAS21002C_Types.h"
+
+/** Most samples in one frame, one full FIFO */
+#define FXAS21002C_STREAM_MAX_SAMPLES (32)
+/** Frame size before COBS encoding, without samples */
+#define FXAS21002C_STREAM_OVERHEAD (1 + 1 + 4 + 5 + 2)
+/** Worst case size on the wire of a frame holding 'n' samples, including
+ * the COBS code byte and the 0x00 delimiter */
+#define FXAS21002C_STREAM_MAX_FRAME(n)                                         \
+  (FXAS21002C_STREAM_OVERHEAD + (n)*6 + 2)
+
+/*!
+    Struct to store the decoder's link statistics
+*/
+typedef struct fxasStreamStats_s {
+  uint32_t frames;        /**< Valid frames decoded */
+  uint32_t samples;       /**< Samples in valid frames */
+  uint32_t crcErrors;     /**< Frames dropped because the CRC did not match */
+  uint32_t framingErrors; /**< Frames dropped as malformed or too long */
+  uint32_t lostFrames;    /**< Frames missing according to 'seq' */
+  uint32_t lostSamples;   /**< Samples missing according to the timestamps */
+} fxasStreamStats_t;
+
+/**************************************************************************/
+/*!
+    @brief  Builds stream frames on the sending side. Write the result with
+            e.g. Serial.write(frame, length).
+*/
+/**************************************************************************/
+class FXAS21002C_Stream {
+public:
+  size_t encode(const gyroRawData_t *samples, uint8_t count,
+                uint32_t timestamp, uint32_t period, uint8_t *out,
+                size_t outSize);
+
+  static uint16_t crc16(const uint8_t *data, size_t len);
+
+private:
+  uint8_t _seq = 0;
+};
+
+/**************************************************************************/
+/*!
+    @brief  Decodes a received byte stream one byte at a time, resyncing on
+            the next 0x00 after any error. The samples of a valid frame are
+            kept until the next frame completes, so getSamples() need not
+            be called right after push() returns true.
+*/
+/**************************************************************************/
+class FXAS21002C_StreamDecoder {
+public:
+  bool push(uint8_t c);
+  uint8_t getSamples(gyroSample_t *out);
+  const fxasStreamStats_t *getStats();
+  void reset();
+
+private:
+  bool decodeFrame();
+
+  uint8_t _buffer[FXAS21002C_STREAM_MAX_FRAME(FXAS21002C_STREAM_MAX_SAMPLES)];
+  size_t _len = 0;
+  bool _overflow = false;
+
+  /* The last valid frame, unpacked so further push() calls keep it */
+  gyroRawData_t _samples[FXAS21002C_STREAM_MAX_SAMPLES];
+  bool _valid = false; ///< The last completed frame was valid
+  uint8_t _count = 0;
+  uint8_t _seq = 0;
+  uint32_t _timestamp = 0;
+  uint32_t _period = 0;
+  bool _synced = false; ///< A valid frame has been seen
+
+  fxasStreamStats_t _stats = {};
+};
+
+#endif
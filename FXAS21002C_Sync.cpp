@@ -0,0 +1,305 @@
+/*!
+ * @file FXAS21002C_Sync.cpp
+ *
+ * Synchronised sampling across several FXAS21002C sensors.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Sync.h"
+#include <math.h>
+
+/** Phase gain of the clock tracking filter. Drain times jitter by up to one
+ * sample period, so the gains are kept low and lock takes ~100 drains. */
+#define SYNC_ALPHA (0.02F)
+/** Period gain of the clock tracking filter, ~alpha^2 / (2 - alpha) */
+#define SYNC_BETA (0.0002F)
+/** Index mask of the history ring */
+#define SYNC_MASK (FXAS21002C_SYNC_HISTORY - 1)
+
+/***************************************************************************
+ CONSTRUCTOR
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Instantiates a new FXAS21002C_Sync class
+*/
+/**************************************************************************/
+FXAS21002C_Sync::FXAS21002C_Sync() {
+  _count = 0;
+  _nominal = 1000000.0F / GYRO_ODR_100HZ;
+  _next = 0;
+}
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Adds a sensor that has already been started with begin(). The
+            first sensor added is the reference that tuples are aligned to.
+    @param  sensor
+            The sensor driver
+    @return The index of the sensor, or -1 if no more sensors fit
+*/
+/**************************************************************************/
+int8_t FXAS21002C_Sync::add(Adafruit_FXAS21002C &sensor) {
+  if (_count >= FXAS21002C_SYNC_MAX)
+    return -1;
+
+  memset(&_entries[_count], 0, sizeof(fxasSyncEntry_t));
+  _entries[_count].sensor = &sensor;
+
+  return _count++;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Configures every sensor for the same ODR with its FIFO in
+            circular mode, then parks them all in standby and activates
+            them back-to-back, so their sample clocks start within a few
+            bus transactions of each other.
+    @param  ODR
+            The output data rate for all sensors. With FXAS21002C_NO_CONFIG
+            the sensors must already run at this rate.
+*/
+/**************************************************************************/
+void FXAS21002C_Sync::start(float ODR) {
+  _nominal = 1000000.0F / ODR;
+
+  for (uint8_t i = 0; i < _count; i++) {
+#ifndef FXAS21002C_NO_CONFIG
+    _entries[i].sensor->setODR(ODR);
+#endif
+    _entries[i].sensor->setFIFOMode(GYRO_FIFO_CIRCULAR);
+  }
+  for (uint8_t i = 0; i < _count; i++) {
+    _entries[i].sensor->standby(true);
+  }
+  for (uint8_t i = 0; i < _count; i++) {
+    _entries[i].sensor->standby(false);
+  }
+
+  /* The first new sample arrives 60ms + 1/ODR after activation, so this
+   * only flushes samples left over from before standby */
+  for (uint8_t i = 0; i < _count; i++) {
+    fxasSyncEntry_t *entry = &_entries[i];
+    entry->sensor->readFIFO(_scratch, FXAS21002C_FIFO_DEPTH);
+    entry->total = 0;
+    entry->period = _nominal;
+    entry->locked = false;
+  }
+  _next = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Drains every sensor's FIFO into its history and updates its
+            clock model. Call this at least every FXAS21002C_SYNC_HISTORY
+            sample periods.
+    @return The number of samples drained
+*/
+/**************************************************************************/
+uint16_t FXAS21002C_Sync::poll() {
+  uint16_t drained = 0;
+
+  for (uint8_t i = 0; i < _count; i++) {
+    fxasSyncEntry_t *entry = &_entries[i];
+    uint8_t n = entry->sensor->readFIFO(_scratch, FXAS21002C_FIFO_DEPTH);
+    uint32_t now = micros();
+    if (n == 0)
+      continue;
+
+    for (uint8_t k = 0; k < n; k++) {
+      entry->history[(entry->total + k) & SYNC_MASK] = _scratch[k];
+    }
+    update(entry, n, now);
+    drained += n;
+  }
+
+  return drained;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets the next time aligned tuple
+    @param[out] tuple
+                One sample per sensor, in add() order
+    @param[out] timestamp
+                The common sample time in microseconds
+    @param  interpolate
+                If true the other sensors are linearly interpolated to the
+                reference sample time, otherwise their nearest sample is
+                used
+    @return True if a tuple was returned, false if not every sensor has
+            data covering the next reference sample yet
+*/
+/**************************************************************************/
+bool FXAS21002C_Sync::read(gyroRawData_t *tuple, uint32_t *timestamp,
+                           bool interpolate) {
+  if (_count == 0)
+    return false;
+  fxasSyncEntry_t *ref = &_entries[0];
+
+  while (ref->locked && (_next < ref->total)) {
+    /* Skip reference samples that have already left the history */
+    if (ref->total - _next > FXAS21002C_SYNC_HISTORY)
+      _next = ref->total - FXAS21002C_SYNC_HISTORY;
+
+    float back = (ref->total - 1 - _next) * ref->period;
+    uint32_t t = ref->newest + (int32_t)floorf(ref->newestFrac - back + 0.5F);
+    tuple[0] = ref->history[_next & SYNC_MASK];
+
+    bool stale = false;
+    for (uint8_t i = 1; i < _count; i++) {
+      fxasSyncEntry_t *entry = &_entries[i];
+      if (!entry->locked)
+        return false;
+
+      float behind = samplesBehind(entry, t);
+      if (behind < 0)
+        return false; // This sensor has not produced that instant yet
+
+      uint32_t older = (uint32_t)behind;
+      float frac = behind - older;
+      if (!interpolate && (frac >= 0.5F)) {
+        older++;
+        frac = 0;
+      }
+      uint32_t available = entry->total < FXAS21002C_SYNC_HISTORY
+                               ? entry->total
+                               : FXAS21002C_SYNC_HISTORY;
+      if (older + (frac > 0 ? 1 : 0) >= available) {
+        stale = true; // Already dropped from the history
+        break;
+      }
+
+      const gyroRawData_t *a = &entry->history[(entry->total - 1 - older) &
+                                               SYNC_MASK];
+      const gyroRawData_t *b = &entry->history[(entry->total - 2 - older) &
+                                               SYNC_MASK];
+      if (frac > 0) {
+        tuple[i].x = (int16_t)floorf(a->x + frac * (b->x - a->x) + 0.5F);
+        tuple[i].y = (int16_t)floorf(a->y + frac * (b->y - a->y) + 0.5F);
+        tuple[i].z = (int16_t)floorf(a->z + frac * (b->z - a->z) + 0.5F);
+      } else {
+        tuple[i] = *a;
+      }
+    }
+
+    _next++;
+    if (!stale) {
+      *timestamp = t;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets a sensor's estimated sample period, i.e. its actual ODR
+            clock measured against micros()
+    @param  index
+            The sensor index returned by add()
+    @return The sample period in microseconds
+*/
+/**************************************************************************/
+float FXAS21002C_Sync::getPeriod(uint8_t index) {
+  return (index < _count) ? _entries[index].period : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Gets a sensor's sampling phase relative to the reference sensor
+    @param  index
+            The sensor index returned by add()
+    @return The offset in microseconds, within +/- half a period, positive
+            if the sensor samples after the reference
+*/
+/**************************************************************************/
+float FXAS21002C_Sync::getPhaseOffset(uint8_t index) {
+  if ((index >= _count) || !_entries[0].locked || !_entries[index].locked)
+    return 0;
+
+  const fxasSyncEntry_t *ref = &_entries[0];
+  const fxasSyncEntry_t *entry = &_entries[index];
+  float offset = (int32_t)(entry->newest - ref->newest) +
+                 (entry->newestFrac - ref->newestFrac);
+  offset = fmodf(offset, ref->period);
+  if (offset > ref->period / 2)
+    offset -= ref->period;
+  if (offset < -ref->period / 2)
+    offset += ref->period;
+
+  return offset;
+}
+
+/***************************************************************************
+ PRIVATE FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Advances a sensor's clock model by one drain. The drain time
+            trails the newest sample by a roughly constant latency, which
+            is the same for every sensor and cancels out in the alignment.
+    @param  entry
+            The sensor
+    @param  count
+            Number of samples in the drain
+    @param  now
+            micros() right after the drain
+*/
+/**************************************************************************/
+void FXAS21002C_Sync::update(fxasSyncEntry_t *entry, uint8_t count,
+                             uint32_t now) {
+  bool overflow = entry->sensor->getFIFOOverflow();
+  entry->total += count;
+
+  /* Samples were lost if the FIFO overflowed, so the count no longer
+   * matches the elapsed time; restart the phase from this drain */
+  if (!entry->locked || overflow) {
+    entry->newest = now;
+    entry->newestFrac = 0;
+    entry->locked = true;
+    return;
+  }
+
+  float advance = entry->newestFrac + count * entry->period;
+  uint32_t whole = (uint32_t)advance;
+  uint32_t predicted = entry->newest + whole;
+  float predictedFrac = advance - whole;
+
+  float error = (int32_t)(now - predicted) - predictedFrac;
+  float corrected = predictedFrac + SYNC_ALPHA * error;
+  int32_t shift = (int32_t)floorf(corrected);
+  entry->newest = predicted + shift;
+  entry->newestFrac = corrected - shift;
+
+  entry->period += SYNC_BETA * error / count;
+  if (entry->period < 0.9F * _nominal)
+    entry->period = 0.9F * _nominal;
+  if (entry->period > 1.1F * _nominal)
+    entry->period = 1.1F * _nominal;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Converts a time into a position in a sensor's history
+    @param  entry
+            The sensor
+    @param  t
+            The time in microseconds
+    @return How many sample periods 't' lies before the newest sample,
+            negative if 't' is newer than the newest sample
+*/
+/**************************************************************************/
+float FXAS21002C_Sync::samplesBehind(const fxasSyncEntry_t *entry,
+                                     uint32_t t) {
+  float delta = (int32_t)(entry->newest - t) + entry->newestFrac;
+  return delta / entry->period;
+}
@@ -0,0 +1,72 @@
+/*!
+ * @file FXAS21002C_Sync.h
+ *
+ * Synchronised sampling across several FXAS21002C sensors: coordinated
+ * start, per sensor clock tracking and time aligned sample tuples.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_SYNC_H__
+#define __FXAS21002C_SYNC_H__
+
+#include "Adafruit_FXAS21002C.h"
+
+#ifndef FXAS21002C_SYNC_MAX
+/** Maximum number of synchronised sensors */
+#define FXAS21002C_SYNC_MAX (4)
+#endif
+
+#ifndef FXAS21002C_SYNC_HISTORY
+/** Samples of history kept per sensor for alignment, power of two */
+#define FXAS21002C_SYNC_HISTORY (32)
+#endif
+
+/**************************************************************************/
+/*!
+    @brief  Samples several sensors on a common timebase. Each sensor's
+            output data clock is tracked with an alpha-beta filter on its
+            FIFO drain times, which estimates its true sample period and
+            phase. read() then returns one tuple per sample of the first
+            (reference) sensor, with the other sensors interpolated or
+            picked nearest at that instant.
+*/
+/**************************************************************************/
+class FXAS21002C_Sync {
+public:
+  FXAS21002C_Sync();
+
+  int8_t add(Adafruit_FXAS21002C &sensor);
+  void start(float ODR);
+  uint16_t poll();
+  bool read(gyroRawData_t *tuple, uint32_t *timestamp,
+            bool interpolate = true);
+
+  float getPeriod(uint8_t index);
+  float getPhaseOffset(uint8_t index);
+
+private:
+  /*!
+      Per sensor clock model and sample history
+  */
+  typedef struct {
+    Adafruit_FXAS21002C *sensor;                   /**< The sensor driver */
+    gyroRawData_t history[FXAS21002C_SYNC_HISTORY]; /**< Newest samples */
+    uint32_t total;   /**< Samples received since start() */
+    uint32_t newest;  /**< Estimated time of the newest sample, whole us */
+    float newestFrac; /**< Fractional part of 'newest' */
+    float period;     /**< Estimated sample period in us */
+    bool locked;      /**< The model has seen at least one drain */
+  } fxasSyncEntry_t;
+
+  void update(fxasSyncEntry_t *entry, uint8_t count, uint32_t now);
+  float samplesBehind(const fxasSyncEntry_t *entry, uint32_t t);
+
+  fxasSyncEntry_t _entries[FXAS21002C_SYNC_MAX];
+  gyroRawData_t _scratch[FXAS21002C_FIFO_DEPTH];
+  uint8_t _count;
+  float _nominal; ///< Nominal sample period in us
+  uint32_t _next; ///< Next reference sample to emit as a tuple
+};
+
+#endif
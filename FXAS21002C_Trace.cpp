@@ -0,0 +1,226 @@
+/*!
+ * @file FXAS21002C_Trace.cpp
+ *
+ * Bus transaction trace recorder and replay source for the FXAS21002C
+ * driver.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Trace.h"
+
+/** Magic at the start of every trace */
+static const uint8_t trace_magic[4] = {'F', 'X', 'T', 'R'};
+
+/***************************************************************************
+ PUBLIC FUNCTIONS
+ ***************************************************************************/
+
+/**************************************************************************/
+/*!
+    @brief  Writes the trace header and starts recording
+    @param  out
+            Where records are written, e.g. an open SD card File
+*/
+/**************************************************************************/
+void FXAS21002C_Trace::beginRecord(Print &out) {
+  end();
+  _out = &out;
+  _out->write(trace_magic, sizeof(trace_magic));
+  _out->write((uint8_t)FXAS21002C_TRACE_VERSION);
+  _time = micros();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Starts replaying a recorded trace
+    @param  trace
+            The complete trace, including its header; it must stay valid
+            until end()
+    @param  len
+            Length of 'trace' in bytes
+*/
+/**************************************************************************/
+void FXAS21002C_Trace::beginReplay(const uint8_t *trace, size_t len) {
+  end();
+  _trace = trace;
+  _len = len;
+  _pos = FXAS21002C_TRACE_HEADER_SIZE;
+  if ((len < FXAS21002C_TRACE_HEADER_SIZE) ||
+      memcmp(trace, trace_magic, sizeof(trace_magic)) ||
+      (trace[4] != FXAS21002C_TRACE_VERSION))
+    _diverged = true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Stops recording or replaying
+*/
+/**************************************************************************/
+void FXAS21002C_Trace::end() {
+  _out = NULL;
+  _trace = NULL;
+  _len = 0;
+  _pos = 0;
+  _time = 0;
+  _diverged = false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks whether transactions are being recorded
+    @return True while recording
+*/
+/**************************************************************************/
+bool FXAS21002C_Trace::recording() { return _out != NULL; }
+
+/**************************************************************************/
+/*!
+    @brief  Checks whether transactions are served from a trace
+    @return True while replaying, also after the replay diverged
+*/
+/**************************************************************************/
+bool FXAS21002C_Trace::replaying() { return _trace != NULL; }
+
+/**************************************************************************/
+/*!
+    @brief  Checks whether the driver asked for a transaction the trace
+            does not hold next, or the trace ran out
+    @return True once the replay has diverged; every later transaction
+            fails
+*/
+/**************************************************************************/
+bool FXAS21002C_Trace::diverged() { return _diverged; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the replay position, for locating a divergence
+    @return Byte offset of the next record in the trace
+*/
+/**************************************************************************/
+size_t FXAS21002C_Trace::position() { return _pos; }
+
+/**************************************************************************/
+/*!
+    @brief  Gets the time of the last transaction
+    @return micros() of the last recorded transaction, or while replaying
+            the recorded time of the last replayed one, counted from the
+            start of the trace
+*/
+/**************************************************************************/
+uint32_t FXAS21002C_Trace::timestamp() { return _time; }
+
+/**************************************************************************/
+/*!
+    @brief  Appends one transaction to the trace. Called by the driver.
+    @param  write
+            True for a register write
+    @param  reg
+            First register address
+    @param  data
+            Bytes written, or bytes read
+    @param  len
+            Length of 'data'
+    @param  ok
+            Result reported by the bus
+*/
+/**************************************************************************/
+void FXAS21002C_Trace::record(bool write, uint8_t reg, const uint8_t *data,
+                              uint8_t len, bool ok) {
+  if (!_out)
+    return;
+
+  uint32_t now = micros();
+  uint32_t delta = now - _time;
+  _time = now;
+
+  uint8_t head[3 + 5];
+  uint8_t n = 0;
+  head[n++] = (write ? FXAS21002C_TRACE_WRITE : 0) |
+              (ok ? FXAS21002C_TRACE_OK : 0);
+  head[n++] = reg;
+  head[n++] = len;
+  while (delta >= 0x80) {
+    head[n++] = (uint8_t)(delta | 0x80);
+    delta >>= 7;
+  }
+  head[n++] = (uint8_t)delta;
+
+  _out->write(head, n);
+  _out->write(data, len);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Serves one transaction from the trace. Called by the driver in
+            place of the bus.
+    @param  write
+            True for a register write
+    @param  reg
+            First register address
+    @param[in,out] data
+            Bytes to write, checked against the trace, or buffer that
+            receives the recorded read
+    @param  len
+            Length of 'data'
+    @return The recorded bus result, false if the replay diverged
+*/
+/**************************************************************************/
+bool FXAS21002C_Trace::replay(bool write, uint8_t reg, uint8_t *data,
+                              uint8_t len) {
+  if (!_trace || _diverged)
+    return false;
+
+  fxasTraceRecord_t rec;
+  size_t used = parse(_trace + _pos, _len - _pos, &rec);
+  if (!used || ((rec.flags & FXAS21002C_TRACE_WRITE) != write) ||
+      (rec.reg != reg) || (rec.len != len) ||
+      (write && memcmp(rec.payload, data, len))) {
+    _diverged = true;
+    return false;
+  }
+
+  if (!write)
+    memcpy(data, rec.payload, len);
+  _pos += used;
+  _time += rec.delta;
+  return rec.flags & FXAS21002C_TRACE_OK;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decodes one record, for tools that walk a trace
+    @param  in
+            Start of the record
+    @param  len
+            Bytes available at 'in'
+    @param[out] rec
+            The decoded record; its payload points into 'in'
+    @return The size of the record in bytes, 0 if it is truncated
+*/
+/**************************************************************************/
+size_t FXAS21002C_Trace::parse(const uint8_t *in, size_t len,
+                               fxasTraceRecord_t *rec) {
+  if (len < 4)
+    return 0;
+
+  rec->flags = in[0];
+  rec->reg = in[1];
+  rec->len = in[2];
+  rec->delta = 0;
+
+  size_t pos = 3;
+  for (uint8_t shift = 0;; shift += 7) {
+    if ((pos >= len) || (shift > 28))
+      return 0;
+    uint8_t b = in[pos++];
+    rec->delta |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80))
+      break;
+  }
+
+  if (len - pos < rec->len)
+    return 0;
+  rec->payload = in + pos;
+  return pos + rec->len;
+}
@@ -0,0 +1,87 @@
+/*!
+ * @file FXAS21002C_Trace.h
+ *
+ * Bus transaction trace recorder and replay source for the FXAS21002C
+ * driver.
+ *
+ * A trace starts with the four bytes "FXTR" and a version byte, followed by
+ * one record per register transaction:
+ *
+ *   uint8_t  flags       bit 0 set for a write, bit 1 set if it succeeded
+ *   uint8_t  reg         first register address
+ *   uint8_t  len         payload length in bytes
+ *   varint   delta       LEB128 microseconds since the previous record
+ *   uint8_t  payload[len] bytes written, or bytes the device returned
+ *
+ * Read-modify-write updates show up as a read followed by a write.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_TRACE_H__
+#define __FXAS21002C_TRACE_H__
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include "FXAS21002C_Host.h"
+#endif
+
+/** Trace format version written after the magic */
+#define FXAS21002C_TRACE_VERSION (1)
+/** Size of the trace header in bytes */
+#define FXAS21002C_TRACE_HEADER_SIZE (5)
+
+/** Record flag: the transaction was a register write */
+#define FXAS21002C_TRACE_WRITE (0x01)
+/** Record flag: the bus reported success */
+#define FXAS21002C_TRACE_OK (0x02)
+
+/*!
+    Struct holding one decoded trace record
+*/
+typedef struct fxasTraceRecord_s {
+  uint8_t flags;          /**< FXAS21002C_TRACE_WRITE / _OK bits */
+  uint8_t reg;            /**< First register address */
+  uint8_t len;            /**< Payload length in bytes */
+  uint32_t delta;         /**< Microseconds since the previous record */
+  const uint8_t *payload; /**< Payload, points into the trace */
+} fxasTraceRecord_t;
+
+/**************************************************************************/
+/*!
+    @brief  Records every register transaction of a sensor, or feeds a
+            recorded trace back in place of the bus. Attach it with
+            Adafruit_FXAS21002C::setTrace(). While replaying, the driver
+            never touches i2c_dev, so the trace can be replayed against any
+            build of the driver, including one without the sensor attached.
+*/
+/**************************************************************************/
+class FXAS21002C_Trace {
+public:
+  void beginRecord(Print &out);
+  void beginReplay(const uint8_t *trace, size_t len);
+  void end();
+
+  bool recording();
+  bool replaying();
+  bool diverged();
+  size_t position();
+  uint32_t timestamp();
+
+  void record(bool write, uint8_t reg, const uint8_t *data, uint8_t len,
+              bool ok);
+  bool replay(bool write, uint8_t reg, uint8_t *data, uint8_t len);
+
+  static size_t parse(const uint8_t *in, size_t len, fxasTraceRecord_t *rec);
+
+private:
+  Print *_out = NULL;
+  const uint8_t *_trace = NULL;
+  size_t _len = 0;
+  size_t _pos = 0;
+  uint32_t _time = 0; ///< Time of the last record, micros() or trace time
+  bool _diverged = false;
+};
+
+#endif
@@ -0,0 +1,47 @@
+/*!
+ * @file FXAS21002C_Transport.h
+ *
+ * Register transport interface for running the FXAS21002C driver on a bus
+ * other than an Arduino TwoWire, such as Linux i2c-dev.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_TRANSPORT_H__
+#define __FXAS21002C_TRANSPORT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**************************************************************************/
+/*!
+    @brief  Register level bus access used by Adafruit_FXAS21002C when it is
+            started with begin(FXAS21002C_Transport &). A burst read must
+            send the register address and read the data in one transfer
+            with a repeated start, as the FIFO and auto-increment logic rely
+            on it.
+*/
+/**************************************************************************/
+class FXAS21002C_Transport {
+public:
+  virtual ~FXAS21002C_Transport() {}
+
+  /*!
+      @brief  Reads consecutive registers
+      @param  reg     The first register to read
+      @param  buffer  Receives the register contents
+      @param  len     Number of bytes to read
+      @return True if the transfer succeeded
+  */
+  virtual bool readRegisters(uint8_t reg, uint8_t *buffer, size_t len) = 0;
+
+  /*!
+      @brief  Writes one register
+      @param  reg    The register to write
+      @param  value  The new register value
+      @return True if the transfer succeeded
+  */
+  virtual bool writeRegister(uint8_t reg, uint8_t value) = 0;
+};
+
+#endif
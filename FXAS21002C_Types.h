@@ -0,0 +1,41 @@
+/*!
+ * @file FXAS21002C_Types.h
+ *
+ * Raw sample types shared by the FXAS21002C driver and its helpers. This
+ * header has no Arduino dependencies, so log decoders can be built on a
+ * host with the same definitions.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_TYPES_H__
+#define __FXAS21002C_TYPES_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*=========================================================================
+    RAW GYROSCOPE DATA TYPE
+    -----------------------------------------------------------------------*/
+/*!
+    Struct to store a single raw (integer-based) gyroscope vector
+*/
+typedef struct gyroRawData_s {
+  int16_t x; /**< Raw int16_t value for the x axis */
+  int16_t y; /**< Raw int16_t value for the y axis */
+  int16_t z; /**< Raw int16_t value for the z axis */
+} gyroRawData_t;
+
+/*!
+    Struct to store a raw gyroscope vector along with its acquisition time
+*/
+typedef struct gyroSample_s {
+  uint32_t timestamp; /**< Acquisition time in microseconds (micros()) */
+  gyroRawData_t data; /**< Raw gyroscope values */
+} gyroSample_t;
+
+static_assert(sizeof(gyroRawData_t) == 6,
+              "gyroRawData_t must match the 6 byte X/Y/Z register layout");
+/*=========================================================================*/
+
+#endif
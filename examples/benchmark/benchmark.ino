@@ -0,0 +1,132 @@
+/* Times the acquisition hot path of the FXAS21002C driver and prints one
+ * CSV line per operation, so runs can be diffed to catch regressions:
+ *
+ *   op,iterations,us_per_sample,bus_bytes_per_sample
+ *
+ * bus_bytes_per_sample is measured, not estimated: the sensor runs on a
+ * transport that issues the same Adafruit_I2CDevice transfers as the
+ * default begin() and counts the register address and data bytes of each
+ * one. The driver never allocates from the heap, so there is no
+ * allocation column.
+ */
+#include <Adafruit_FXAS21002C.h>
+#include <Adafruit_I2CDevice.h>
+#include <Adafruit_Sensor.h>
+#include <FXAS21002C_Transport.h>
+#include <Wire.h>
+
+#define ITERATIONS 200
+
+/* Same transfers as the driver's own I2C path, plus a byte count */
+class CountingBus : public FXAS21002C_Transport {
+public:
+  CountingBus(Adafruit_I2CDevice &dev) : _dev(dev) {}
+
+  bool readRegisters(uint8_t reg, uint8_t *buffer, size_t len) {
+    bytes += 1 + len;
+    return _dev.write_then_read(&reg, 1, buffer, len);
+  }
+
+  bool writeRegister(uint8_t reg, uint8_t value) {
+    uint8_t buffer[2] = {reg, value};
+    bytes += 2;
+    return _dev.write(buffer, 2);
+  }
+
+  uint32_t bytes = 0;
+
+private:
+  Adafruit_I2CDevice &_dev;
+};
+
+Adafruit_I2CDevice dev = Adafruit_I2CDevice(0x21, &Wire);
+CountingBus bus(dev);
+Adafruit_FXAS21002C gyro = Adafruit_FXAS21002C(0x0021002C);
+
+void report(const char *op, uint32_t iterations, uint32_t us,
+            uint32_t samples, uint32_t busBytes) {
+  Serial.print(op);
+  Serial.print(",");
+  Serial.print(iterations);
+  Serial.print(",");
+  Serial.print(samples ? (float)us / samples : 0, 2);
+  Serial.print(",");
+  Serial.println(samples ? (float)busBytes / samples : 0, 2);
+}
+
+void setup(void) {
+  Serial.begin(115200);
+
+  /* Wait for the Serial Monitor */
+  while (!Serial) {
+    delay(1);
+  }
+
+  if (!dev.begin() || !gyro.begin(bus)) {
+    Serial.println("Ooops, no FXAS21002C detected ... Check your wiring!");
+    while (1)
+      ;
+  }
+  gyro.setODR(GYRO_ODR_800HZ);
+
+  Serial.println("op,iterations,us_per_sample,bus_bytes_per_sample");
+
+  /* getEvent(): one burst from STATUS plus float conversion */
+  sensors_event_t event;
+  bus.bytes = 0;
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    gyro.getEvent(&event);
+  }
+  report("getEvent", ITERATIONS, micros() - start, ITERATIONS, bus.bytes);
+
+  /* readRaw(): one burst from OUT_X_MSB, no conversion */
+  gyroRawData_t raw;
+  bus.bytes = 0;
+  start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    gyro.readRaw(&raw);
+  }
+  report("readRaw", ITERATIONS, micros() - start, ITERATIONS, bus.bytes);
+
+  /* Batch conversion of raw samples to rad/s, no bus traffic */
+  gyroRawData_t batch[FXAS21002C_FIFO_DEPTH];
+  memset(batch, 0, sizeof(batch));
+  float scale = gyro.sensitivity() * SENSORS_DPS_TO_RADS;
+  volatile float sink = 0;
+  start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    for (uint8_t k = 0; k < FXAS21002C_FIFO_DEPTH; k++) {
+      sink = sink + batch[k].x * scale + batch[k].y * scale +
+             batch[k].z * scale;
+    }
+  }
+  report("convert", ITERATIONS, micros() - start,
+         (uint32_t)ITERATIONS * FXAS21002C_FIFO_DEPTH, 0);
+
+  /* readFIFO(): F_STATUS plus one burst per drain, with a full FIFO */
+  gyro.setFIFOMode(GYRO_FIFO_CIRCULAR);
+  uint32_t us = 0, samples = 0;
+  bus.bytes = 0;
+  for (uint16_t i = 0; i < ITERATIONS / 10; i++) {
+    delay(FXAS21002C_FIFO_DEPTH * 1000UL / 800 + 1);
+    start = micros();
+    uint8_t n = gyro.readFIFO(batch, FXAS21002C_FIFO_DEPTH);
+    us += micros() - start;
+    samples += n;
+  }
+  report("readFIFO", ITERATIONS / 10, us, samples, bus.bytes);
+  gyro.setFIFOMode(GYRO_FIFO_DISABLED);
+
+  /* Configuration changes, reported per call */
+  bus.bytes = 0;
+  start = micros();
+  gyro.setRange(GYRO_RANGE_500DPS);
+  report("setRange", 1, micros() - start, 1, bus.bytes);
+  bus.bytes = 0;
+  start = micros();
+  gyro.setODR(GYRO_ODR_400HZ);
+  report("setODR", 1, micros() - start, 1, bus.bytes);
+}
+
+void loop(void) {}
@@ -0,0 +1,47 @@
+/* Streams every gyroscope sample at 800 Hz as binary frames (see
+ * FXAS21002C_Stream.h) instead of printing text. Decode the frames on the
+ * receiving side with FXAS21002C_StreamDecoder, which also counts lost and
+ * corrupted frames.
+ */
+#include <Adafruit_FXAS21002C.h>
+#include <FXAS21002C_Stream.h>
+#include <Wire.h>
+
+Adafruit_FXAS21002C gyro = Adafruit_FXAS21002C(0x0021002C);
+FXAS21002C_Stream stream;
+
+gyroRawData_t samples[FXAS21002C_FIFO_DEPTH];
+uint8_t frame[FXAS21002C_STREAM_MAX_FRAME(FXAS21002C_FIFO_DEPTH)];
+uint32_t period;
+
+void setup(void) {
+  Serial.begin(115200);
+
+  /* Wait for the Serial Monitor */
+  while (!Serial) {
+    delay(1);
+  }
+
+  if (!gyro.begin()) {
+    /* No text on the binary stream; just stop */
+    while (1)
+      ;
+  }
+  gyro.setODR(GYRO_ODR_800HZ);
+  gyro.setFIFOMode(GYRO_FIFO_CIRCULAR);
+  period = gyro.getPeriodUs();
+}
+
+void loop(void) {
+  /* Send roughly every 8 samples; the FIFO absorbs Serial stalls */
+  delay(10);
+
+  uint8_t n = gyro.readFIFO(samples, FXAS21002C_FIFO_DEPTH);
+  if (!n)
+    return;
+
+  /* The newest sample was taken around now */
+  uint32_t first = micros() - (n - 1) * period;
+  size_t len = stream.encode(samples, n, first, period, frame, sizeof(frame));
+  Serial.write(frame, len);
+}
@@ -0,0 +1,129 @@
+/* Duty-cycled acquisition: the gyroscope fills its FIFO while the MCU
+ * sleeps, the FIFO watermark interrupt on INT1 wakes the MCU, which drains
+ * the FIFO and goes back to sleep. Connect INT1 to an interrupt capable
+ * pin (pin 2 = INT0 on an Uno).
+ *
+ * On AVR the MCU goes to power-down and only the INT1 pin wakes it. On ARM
+ * it waits in WFI; the SysTick tick still wakes it every millisecond, but
+ * it goes straight back to sleep without touching the bus. Deeper ARM
+ * sleep modes are board specific. Elsewhere the sketch waits no longer
+ * than getSafeSleepUs() allows. */
+#include <Adafruit_FXAS21002C.h>
+#include <Wire.h>
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#endif
+
+#define INT1_PIN 2
+#define WATERMARK 24
+
+#if defined(__AVR__)
+/* Only a level interrupt can wake an AVR from power-down */
+#define WAKE_MODE LOW
+#else
+#define WAKE_MODE FALLING
+#endif
+
+Adafruit_FXAS21002C gyro = Adafruit_FXAS21002C(0x0021002C);
+
+gyroRawData_t samples[FXAS21002C_FIFO_DEPTH];
+volatile bool fifoReady = false;
+
+void onWatermark(void) {
+  fifoReady = true;
+#if defined(__AVR__)
+  /* INT1 stays low until the FIFO is drained, stop the level interrupt */
+  detachInterrupt(digitalPinToInterrupt(INT1_PIN));
+#endif
+}
+
+void armWatermark(void) {
+  attachInterrupt(digitalPinToInterrupt(INT1_PIN), onWatermark, WAKE_MODE);
+}
+
+void waitForWatermark(void) {
+#if defined(__AVR__)
+  Serial.flush();
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  cli();
+  while (!fifoReady) {
+    sleep_enable();
+    /* The instruction after sei() runs before any interrupt, so a wake-up
+     * between the check and sleep_cpu() is not lost */
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    cli();
+  }
+  sei();
+#elif defined(__arm__)
+  __disable_irq();
+  while (!fifoReady) {
+    /* WFI also returns on an interrupt that is pending while masked */
+    __WFI();
+    __enable_irq();
+    __disable_irq();
+  }
+  __enable_irq();
+#else
+  /* No portable sleep; drain anyway once the FIFO could overflow */
+  uint32_t maxUs = gyro.getSafeSleepUs();
+  uint32_t start = micros();
+  while (!fifoReady && (micros() - start < maxUs)) {
+    delay(1);
+  }
+#endif
+}
+
+void drain(void) {
+  uint8_t n = gyro.readFIFO(samples, FXAS21002C_FIFO_DEPTH);
+  if (gyro.getFIFOOverflow()) {
+    Serial.println("FIFO overflowed, samples lost");
+  }
+
+  /* Process the burst; here just report its size and the last sample */
+  if (n) {
+    Serial.print(n);
+    Serial.print(" samples, last X: ");
+    Serial.print(samples[n - 1].x);
+    Serial.print(" Y: ");
+    Serial.print(samples[n - 1].y);
+    Serial.print(" Z: ");
+    Serial.println(samples[n - 1].z);
+  }
+}
+
+void setup(void) {
+  Serial.begin(115200);
+
+  /* Wait for the Serial Monitor */
+  while (!Serial) {
+    delay(1);
+  }
+
+  if (!gyro.begin()) {
+    Serial.println("Ooops, no FXAS21002C detected ... Check your wiring!");
+    while (1)
+      ;
+  }
+  gyro.setODR(GYRO_ODR_100HZ);
+  gyro.setFIFOMode(GYRO_FIFO_CIRCULAR, WATERMARK);
+  gyro.enableFIFOInterrupt(GYRO_INT_PIN_1);
+
+  /* INT1 may already be asserted; draining releases it so the first
+   * watermark produces a fresh edge */
+  pinMode(INT1_PIN, INPUT);
+  drain();
+  armWatermark();
+}
+
+void loop(void) {
+  waitForWatermark();
+  fifoReady = false;
+
+  /* Reading the FIFO status releases INT1 */
+  drain();
+#if defined(__AVR__)
+  armWatermark();
+#endif
+}
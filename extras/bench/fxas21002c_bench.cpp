@@ -0,0 +1,235 @@
+/*!
+ * @file fxas21002c_bench.cpp
+ *
+ * Host benchmark of the FXAS21002C driver's acquisition hot path, the
+ * counterpart of examples/benchmark for a Linux or other POSIX host. The
+ * driver runs on FXAS21002C_Sim behind a transport that counts the
+ * register address and data bytes of every transfer. Prints one CSV line
+ * per operation, so runs can be diffed to catch regressions:
+ *
+ *   op,iterations,ns_per_sample,instructions_per_sample,bus_bytes_per_sample
+ *
+ * ns_per_sample is CLOCK_MONOTONIC time. instructions_per_sample counts
+ * user space instructions with perf_event_open(); it reads "NA" where no
+ * counter is available, e.g. in containers or with
+ * kernel.perf_event_paranoid > 2. Both include the model answering the
+ * transfers. Build and run from the repository root, with
+ * Adafruit_Sensor.h on the include path:
+ *
+ *   g++ -O2 -I. -I<Adafruit_Sensor> extras/bench/fxas21002c_bench.cpp \
+ *       Adafruit_FXAS21002C.cpp FXAS21002C_Host.cpp FXAS21002C_Sim.cpp \
+ *       FXAS21002C_Trace.cpp -o fxas21002c_bench
+ *   ./fxas21002c_bench
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "Adafruit_FXAS21002C.h"
+#include "FXAS21002C_Sim.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+/** Iterations of the per-sample operations */
+#define ITERATIONS 100000
+
+/** Same transfers as the simulation, plus a byte count */
+class CountingBus : public FXAS21002C_Transport {
+public:
+  CountingBus(FXAS21002C_Transport &bus) : _bus(bus) {}
+
+  bool readRegisters(uint8_t reg, uint8_t *buffer, size_t len) {
+    bytes += 1 + len;
+    return _bus.readRegisters(reg, buffer, len);
+  }
+
+  bool writeRegister(uint8_t reg, uint8_t value) {
+    bytes += 2;
+    return _bus.writeRegister(reg, value);
+  }
+
+  uint64_t bytes = 0; ///< Bytes on the bus since the last reset
+
+private:
+  FXAS21002C_Transport &_bus;
+};
+
+/** Monotonic time and, where available, retired user space instructions
+ * of the calling thread over one measured section */
+class Meter {
+public:
+  Meter() {
+#if defined(__linux__)
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    _fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+  }
+
+  ~Meter() {
+    if (_fd >= 0)
+      close(_fd);
+  }
+
+  /** Whether instruction counts are available */
+  bool counting() { return _fd >= 0; }
+
+  /** Starts a measured section, not nested */
+  void start() {
+    ns = 0;
+    instructions = 0;
+#if defined(__linux__)
+    if (_fd >= 0)
+      ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+#endif
+    resume();
+  }
+
+  /** Continues the measured section after pause() */
+  void resume() {
+#if defined(__linux__)
+    if (_fd >= 0)
+      ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    _start = now();
+  }
+
+  /** Stops the measured section, keeping the totals so far */
+  void pause() {
+    ns += now() - _start;
+#if defined(__linux__)
+    if (_fd >= 0) {
+      ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+      uint64_t count = 0;
+      if (read(_fd, &count, sizeof(count)) == sizeof(count))
+        instructions = count;
+    }
+#endif
+  }
+
+  uint64_t ns = 0;           ///< Time in measured sections
+  uint64_t instructions = 0; ///< Instructions in measured sections
+
+private:
+  static uint64_t now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  }
+
+  int _fd = -1;
+  uint64_t _start = 0;
+};
+
+static FXAS21002C_Sim sim;
+static CountingBus bus(sim);
+static Meter meter;
+
+/** Prints one CSV line from the meter and the bus counter */
+static void report(const char *op, uint32_t iterations, uint32_t samples) {
+  printf("%s,%u,", op, iterations);
+  printf("%.1f,", samples ? (double)meter.ns / samples : 0);
+  if (meter.counting())
+    printf("%.1f,", samples ? (double)meter.instructions / samples : 0);
+  else
+    printf("NA,");
+  printf("%.2f\n", samples ? (double)bus.bytes / samples : 0);
+}
+
+int main() {
+  FXAS21002C_Clock::set(&sim);
+  Adafruit_FXAS21002C gyro;
+  if (!gyro.begin(bus)) {
+    fprintf(stderr, "FXAS21002C_Sim did not start\n");
+    return 1;
+  }
+  gyro.setODR(GYRO_ODR_800HZ);
+  sim.setRate(10, -20, 30);
+  sim.setNoise(4);
+
+  printf("op,iterations,ns_per_sample,instructions_per_sample,"
+         "bus_bytes_per_sample\n");
+
+  /* getEvent(): one burst from STATUS plus float conversion */
+  sensors_event_t event;
+  bus.bytes = 0;
+  meter.start();
+  for (uint32_t i = 0; i < ITERATIONS; i++)
+    gyro.getEvent(&event);
+  meter.pause();
+  report("getEvent", ITERATIONS, ITERATIONS);
+
+  /* readRaw(): one burst from OUT_X_MSB, no conversion */
+  gyroRawData_t raw;
+  bus.bytes = 0;
+  meter.start();
+  for (uint32_t i = 0; i < ITERATIONS; i++)
+    gyro.readRaw(&raw);
+  meter.pause();
+  report("readRaw", ITERATIONS, ITERATIONS);
+
+  /* Batch conversion of raw samples to rad/s, no bus traffic */
+  gyroRawData_t batch[FXAS21002C_FIFO_DEPTH];
+  for (uint8_t k = 0; k < FXAS21002C_FIFO_DEPTH; k++)
+    gyro.readRaw(&batch[k]);
+  float scale = gyro.sensitivity() * SENSORS_DPS_TO_RADS;
+  volatile float sink = 0;
+  bus.bytes = 0;
+  meter.start();
+  for (uint32_t i = 0; i < ITERATIONS; i++) {
+    for (uint8_t k = 0; k < FXAS21002C_FIFO_DEPTH; k++)
+      sink = sink + batch[k].x * scale + batch[k].y * scale +
+             batch[k].z * scale;
+  }
+  meter.pause();
+  report("convert", ITERATIONS,
+         (uint32_t)ITERATIONS * FXAS21002C_FIFO_DEPTH);
+
+  /* readFIFO(): F_STATUS plus one burst per drain, with a full FIFO; the
+   * virtual time that fills it is not measured */
+  gyro.setFIFOMode(GYRO_FIFO_CIRCULAR);
+  uint32_t samples = 0;
+  bus.bytes = 0;
+  meter.start();
+  for (uint32_t i = 0; i < ITERATIONS / 10; i++) {
+    meter.pause();
+    delay(FXAS21002C_FIFO_DEPTH * 1000UL / 800 + 1);
+    meter.resume();
+    samples += gyro.readFIFO(batch, FXAS21002C_FIFO_DEPTH);
+  }
+  meter.pause();
+  report("readFIFO", ITERATIONS / 10, samples);
+  gyro.setFIFOMode(GYRO_FIFO_DISABLED);
+
+  /* Configuration changes, reported per call */
+  bus.bytes = 0;
+  meter.start();
+  for (uint32_t i = 0; i < ITERATIONS / 100; i++)
+    gyro.setRange((i & 1) ? GYRO_RANGE_250DPS : GYRO_RANGE_500DPS);
+  meter.pause();
+  report("setRange", ITERATIONS / 100, ITERATIONS / 100);
+  bus.bytes = 0;
+  meter.start();
+  for (uint32_t i = 0; i < ITERATIONS / 100; i++)
+    gyro.setODR((i & 1) ? GYRO_ODR_800HZ : GYRO_ODR_400HZ);
+  meter.pause();
+  report("setODR", ITERATIONS / 100, ITERATIONS / 100);
+
+  if (sim.violations())
+    fprintf(stderr, "%u writes the datasheet forbids\n", sim.violations());
+  return 0;
+}
@@ -0,0 +1,365 @@
+/*!
+ * @file fxas21002c_convert.cpp
+ *
+ * Host converter from recorded logs to the columnar archive format (see
+ * FXAS21002C_Columnar.h), or to CSV. Reads FXAS21002C_ChunkLog files and
+ * plain streams of FXAS21002C_RiceLog or FXAS21002C_DeltaLog blocks,
+ * detected from the first bytes.
+ *
+ * Blocks are self contained, so the log is indexed on one thread and the
+ * blocks are then decoded on all worker threads. The samples are cut into
+ * columnar chunks wherever the period changes or the time base jumps, and
+ * the chunks are encoded on all worker threads again. The log is processed
+ * in windows of blocks, so memory use does not grow with the log. DeltaLog
+ * blocks carry no size, so indexing them decodes them once on the first
+ * thread. Build from the repository root:
+ *
+ *   g++ -O2 -I. extras/convert/fxas21002c_convert.cpp \
+ *       FXAS21002C_ChunkLog.cpp FXAS21002C_Columnar.cpp \
+ *       FXAS21002C_DeltaLog.cpp FXAS21002C_RiceLog.cpp -pthread \
+ *       -o fxas21002c_convert
+ *
+ * Usage:
+ *
+ *   fxas21002c_convert [-j threads] [-n samples] [-f columnar|csv]
+ *                      [-o out] log
+ *
+ * -n is the most samples per columnar chunk (default 4096). CSV lines are
+ * "timestamp,x,y,z" with 64 bit timestamps in microseconds. Output goes
+ * to stdout without -o; a summary goes to stderr.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_ChunkLog.h"
+#include "FXAS21002C_Columnar.h"
+#include "FXAS21002C_DeltaLog.h"
+#include "FXAS21002C_RiceLog.h"
+
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/** Blocks decoded per window */
+#define WINDOW (4096)
+/** Most samples in one RiceLog or DeltaLog block */
+#define BLOCK_SAMPLES (256)
+
+/** One self contained block of the input log */
+struct block_s {
+  const uint8_t *data; ///< Start of the block
+  size_t len;          ///< Size of the block in bytes
+  bool delta;          ///< DeltaLog block, otherwise RiceLog
+  bool anchored;       ///< 'anchor' holds the 64 bit time of sample 0
+  uint64_t anchor;     ///< Chunk start time from a ChunkLog header
+};
+
+/** The decoded samples of one block */
+struct decoded_s {
+  std::vector<gyroSample_t> samples;
+  uint32_t period;
+  bool ok;
+};
+
+/** Samples sharing one time base, encoded as one columnar chunk */
+struct chunk_s {
+  uint64_t start;
+  uint32_t period;
+  std::vector<gyroRawData_t> samples;
+  std::vector<uint8_t> out; ///< The encoded chunk
+};
+
+static uint32_t getU32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/** Prints the usage line and exits */
+static void usage(const char *self) {
+  fprintf(stderr,
+          "usage: %s [-j threads] [-n samples] [-f columnar|csv] [-o out] "
+          "log\n",
+          self);
+  exit(2);
+}
+
+/** Runs fn(0) to fn(count - 1) on 'threads' threads, the caller included */
+template <typename F>
+static void parallel(unsigned threads, size_t count, const F &fn) {
+  std::atomic<size_t> next(0);
+  auto work = [&]() {
+    for (size_t i; (i = next.fetch_add(1)) < count;)
+      fn(i);
+  };
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads && t < count; t++)
+    pool.emplace_back(work);
+  work();
+  for (size_t t = 0; t < pool.size(); t++)
+    pool[t].join();
+}
+
+/** Splits a stream of RiceLog blocks, returns the bytes it could not use */
+static size_t indexRice(const uint8_t *in, size_t len,
+                        std::vector<block_s> *blocks) {
+  size_t pos = 0;
+  while (pos < len) {
+    size_t size = FXAS21002C_RiceLog::blockSize(in + pos, len - pos);
+    if (!size)
+      break;
+    blocks->push_back(block_s{in + pos, size, false, false, 0});
+    pos += size;
+  }
+  return len - pos;
+}
+
+/** Splits a stream of DeltaLog blocks, returns the bytes it could not use */
+static size_t indexDelta(const uint8_t *in, size_t len,
+                         std::vector<block_s> *blocks) {
+  gyroSample_t scratch[BLOCK_SAMPLES];
+  size_t pos = 0;
+  while (pos < len) {
+    size_t size = 0;
+    if (FXAS21002C_DeltaLog::decode(in + pos, len - pos, scratch,
+                                    BLOCK_SAMPLES, &size) < 0)
+      break;
+    blocks->push_back(block_s{in + pos, size, true, false, 0});
+    pos += size;
+  }
+  return len - pos;
+}
+
+/** Splits a ChunkLog into the RiceLog blocks of its chunks, returns the
+ * number of chunks with an invalid header or payload */
+static uint32_t indexChunks(const uint8_t *in, size_t len,
+                            std::vector<block_s> *blocks) {
+  FXAS21002C_ChunkReader reader(in, len);
+  size_t chunkSize = len >= 8 ? getU32(in + 4) : 0;
+  uint32_t bad = 0;
+  for (uint32_t i = 0; i < reader.chunks(); i++) {
+    fxasChunkInfo_t info;
+    if (!reader.getInfo(i, &info)) {
+      bad++;
+      continue;
+    }
+    const uint8_t *chunk = in + (size_t)i * chunkSize;
+    size_t payload = chunk[26] | (chunk[27] << 8);
+    size_t first = blocks->size();
+    if (indexRice(chunk + FXAS21002C_CHUNKLOG_HEADER_SIZE, payload, blocks))
+      bad++;
+    if (blocks->size() > first) {
+      (*blocks)[first].anchored = true;
+      (*blocks)[first].anchor = info.start;
+    }
+  }
+  return bad;
+}
+
+/** Decodes one block and reads its period from the header */
+static void decodeBlock(const block_s &block, decoded_s *d) {
+  d->samples.resize(BLOCK_SAMPLES);
+  int16_t n = block.delta
+                  ? FXAS21002C_DeltaLog::decode(block.data, block.len,
+                                                &d->samples[0], BLOCK_SAMPLES)
+                  : FXAS21002C_RiceLog::decode(block.data, block.len,
+                                               &d->samples[0], BLOCK_SAMPLES);
+  d->ok = n >= 0;
+  d->samples.resize(d->ok ? n : 0);
+  d->period = getU32(block.data + (block.delta ? 6 : 8));
+}
+
+/** Extends 32 bit block timestamps to one 64 bit time line */
+class Timeline {
+public:
+  uint64_t extend(uint32_t t) {
+    if (!_valid) {
+      _time = t;
+      _valid = true;
+    }
+    _time += (int32_t)(t - (uint32_t)_time);
+    return _time;
+  }
+
+  void anchor(uint64_t time) {
+    _time = time;
+    _valid = true;
+  }
+
+private:
+  uint64_t _time = 0;
+  bool _valid = false;
+};
+
+int main(int argc, char **argv) {
+  unsigned threads = std::thread::hardware_concurrency();
+  uint32_t chunkSamples = 4096;
+  bool csv = false;
+  const char *outName = NULL;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "j:n:f:o:")) != -1) {
+    switch (opt) {
+    case 'j':
+      threads = strtoul(optarg, NULL, 0);
+      break;
+    case 'n':
+      chunkSamples = strtoul(optarg, NULL, 0);
+      break;
+    case 'f':
+      if (!strcmp(optarg, "csv"))
+        csv = true;
+      else if (strcmp(optarg, "columnar"))
+        usage(argv[0]);
+      break;
+    case 'o':
+      outName = optarg;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if ((optind != argc - 1) || !chunkSamples || (chunkSamples > 65535))
+    usage(argv[0]);
+  if (!threads)
+    threads = 1;
+
+  /* Map the whole log */
+  const char *inName = argv[optind];
+  int fd = open(inName, O_RDONLY);
+  struct stat st;
+  if ((fd < 0) || (fstat(fd, &st) < 0)) {
+    fprintf(stderr, "%s: %s\n", inName, strerror(errno));
+    return 1;
+  }
+  size_t len = st.st_size;
+  const uint8_t *log = NULL;
+  if (len) {
+    void *p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      fprintf(stderr, "%s: %s\n", inName, strerror(errno));
+      return 1;
+    }
+    log = (const uint8_t *)p;
+  }
+  close(fd);
+
+  std::vector<block_s> blocks;
+  size_t trailing = 0;
+  uint32_t badChunks = 0;
+  if ((len >= 4) && !memcmp(log, "FXCK", 4))
+    badChunks = indexChunks(log, len, &blocks);
+  else if (len && (log[0] == FXAS21002C_RICELOG_MARKER))
+    trailing = indexRice(log, len, &blocks);
+  else if (len && (log[0] == FXAS21002C_DELTALOG_MARKER))
+    trailing = indexDelta(log, len, &blocks);
+  else {
+    fprintf(stderr, "%s: not a ChunkLog, RiceLog or DeltaLog file\n", inName);
+    return 1;
+  }
+
+  FILE *out = outName ? fopen(outName, "wb") : stdout;
+  if (!out) {
+    fprintf(stderr, "%s: %s\n", outName, strerror(errno));
+    return 1;
+  }
+
+  Timeline timeline;
+  chunk_s pending = {0, 0, {}, {}};
+  std::vector<decoded_s> decoded;
+  std::vector<chunk_s> chunks;
+  uint64_t samples = 0, outBytes = 0, chunkCount = 0;
+  uint32_t badBlocks = 0;
+
+  for (size_t first = 0; first < blocks.size(); first += WINDOW) {
+    size_t n = blocks.size() - first;
+    if (n > WINDOW)
+      n = WINDOW;
+
+    /* Blocks are independent: decode the window on every thread */
+    decoded.resize(n);
+    parallel(threads, n,
+             [&](size_t i) { decodeBlock(blocks[first + i], &decoded[i]); });
+
+    /* Put the samples on the 64 bit time line in order, and cut chunks
+     * where the time base changes */
+    chunks.clear();
+    for (size_t i = 0; i < n; i++) {
+      const decoded_s &d = decoded[i];
+      if (!d.ok) {
+        badBlocks++;
+        continue;
+      }
+      if (blocks[first + i].anchored)
+        timeline.anchor(blocks[first + i].anchor);
+      for (size_t k = 0; k < d.samples.size(); k++) {
+        uint64_t t = timeline.extend(d.samples[k].timestamp);
+        samples++;
+        if (csv) {
+          fprintf(out, "%llu,%d,%d,%d\n", (unsigned long long)t,
+                  d.samples[k].data.x, d.samples[k].data.y,
+                  d.samples[k].data.z);
+          continue;
+        }
+
+        uint64_t expected =
+            pending.start + (uint64_t)pending.samples.size() * pending.period;
+        int64_t skew = (int64_t)(t - expected);
+        if (pending.samples.empty() || (pending.period != d.period) ||
+            (pending.samples.size() >= chunkSamples) ||
+            (skew > (int64_t)(d.period / 2)) ||
+            (skew < -(int64_t)(d.period / 2))) {
+          if (!pending.samples.empty())
+            chunks.push_back(std::move(pending));
+          pending = chunk_s{t, d.period, {}, {}};
+        }
+        pending.samples.push_back(d.samples[k].data);
+      }
+    }
+    if (blocks.size() - first <= WINDOW && !pending.samples.empty())
+      chunks.push_back(std::move(pending));
+
+    /* Chunks are independent too: encode them on every thread */
+    parallel(threads, chunks.size(), [&](size_t i) {
+      chunk_s &c = chunks[i];
+      c.out.resize(FXAS21002C_COLUMNAR_MAX_CHUNK(c.samples.size()));
+      c.out.resize(FXAS21002C_Columnar::encode(
+          c.samples.data(), c.samples.size(), c.start, c.period,
+          c.out.data(), c.out.size()));
+    });
+    for (size_t i = 0; i < chunks.size(); i++) {
+      if (chunks[i].out.empty()) {
+        fprintf(stderr, "chunk at %llu us did not encode\n",
+                (unsigned long long)chunks[i].start);
+        return 1;
+      }
+      fwrite(chunks[i].out.data(), 1, chunks[i].out.size(), out);
+      outBytes += chunks[i].out.size();
+    }
+    chunkCount += chunks.size();
+  }
+
+  bool ok = !ferror(out);
+  if (out != stdout)
+    ok = !fclose(out) && ok;
+  if (log)
+    munmap((void *)log, len);
+
+  fprintf(stderr,
+          "%zu blocks (%u invalid, %u invalid chunks, %zu trailing bytes), "
+          "%llu samples, %llu chunks, %zu -> %llu bytes on %u threads\n",
+          blocks.size(), badBlocks, badChunks, trailing,
+          (unsigned long long)samples, (unsigned long long)chunkCount, len,
+          (unsigned long long)outBytes, threads);
+  if (!ok) {
+    fprintf(stderr, "%s: write failed\n", outName ? outName : "stdout");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,161 @@
+/*!
+ * @file fxas21002c_shmd.cpp
+ *
+ * Acquisition daemon for Linux: owns an FXAS21002C on /dev/i2c-N, drains
+ * its FIFO and publishes every timestamped sample into an
+ * FXAS21002C_ShmRing that any number of readers attach() to. Build from
+ * the repository root:
+ *
+ *   g++ -DFXAS21002C_NO_FLOAT -I. extras/shmd/fxas21002c_shmd.cpp \
+ *       Adafruit_FXAS21002C.cpp FXAS21002C_Host.cpp \
+ *       FXAS21002C_LinuxI2C.cpp FXAS21002C_ShmRing.cpp \
+ *       FXAS21002C_Trace.cpp -lrt -o fxas21002c_shmd
+ *
+ * Usage:
+ *
+ *   fxas21002c_shmd [-d /dev/i2c-1] [-a 0x21] [-n /fxas21002c]
+ *                   [-r 800] [-c 4096] [-u]
+ *
+ * -r is the output data rate in Hz, -c the ring capacity in samples
+ * (rounded down to a power of two) and -u unlinks the ring on exit. By
+ * default the ring stays in place, so a restarted daemon bumps its
+ * generation and attached readers follow it without attaching again.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "Adafruit_FXAS21002C.h"
+#include "FXAS21002C_LinuxI2C.h"
+#include "FXAS21002C_ShmRing.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/** Set by SIGINT or SIGTERM */
+static volatile sig_atomic_t stopping = 0;
+
+/** Signal handler asking the main loop to finish */
+static void stop(int sig) {
+  (void)sig;
+  stopping = 1;
+}
+
+/** Prints the usage line and exits */
+static void usage(const char *self) {
+  fprintf(stderr,
+          "usage: %s [-d device] [-a addr] [-n name] [-r hz] [-c capacity] "
+          "[-u]\n",
+          self);
+  exit(2);
+}
+
+/** Checks that 'hz' is one of the device's output data rates */
+static bool validODR(float hz) {
+  static const float rates[] = {GYRO_ODR_800HZ, GYRO_ODR_400HZ,
+                                GYRO_ODR_200HZ, GYRO_ODR_100HZ,
+                                GYRO_ODR_50HZ,  GYRO_ODR_25HZ,
+                                GYRO_ODR_12_5HZ};
+  for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+    if (hz == rates[i])
+      return true;
+  return false;
+}
+
+int main(int argc, char **argv) {
+  const char *device = "/dev/i2c-1";
+  const char *name = "/fxas21002c";
+  uint8_t addr = 0x21;
+  float odr = GYRO_ODR_800HZ;
+  uint32_t capacity = 4096;
+  bool unlinkOnExit = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:a:n:r:c:u")) != -1) {
+    switch (opt) {
+    case 'd':
+      device = optarg;
+      break;
+    case 'a':
+      addr = (uint8_t)strtoul(optarg, NULL, 0);
+      break;
+    case 'n':
+      name = optarg;
+      break;
+    case 'r':
+      odr = strtof(optarg, NULL);
+      break;
+    case 'c':
+      capacity = strtoul(optarg, NULL, 0);
+      break;
+    case 'u':
+      unlinkOnExit = true;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (optind != argc || !validODR(odr) || capacity < 2)
+    usage(argv[0]);
+
+  FXAS21002C_LinuxI2C bus;
+  if (!bus.begin(device, addr)) {
+    fprintf(stderr, "%s: %s\n", device, strerror(bus.lastError()));
+    return 1;
+  }
+  Adafruit_FXAS21002C gyro;
+  if (!gyro.begin(bus)) {
+    fprintf(stderr, "no FXAS21002C at 0x%02x on %s\n", addr, device);
+    return 1;
+  }
+  gyro.setODR(odr);
+  gyro.setFIFOMode(GYRO_FIFO_CIRCULAR);
+
+  uint32_t period = gyro.getPeriodUs();
+  FXAS21002C_ShmRing ring;
+  if (!ring.create(name, capacity, period)) {
+    fprintf(stderr, "cannot create %s\n", name);
+    return 1;
+  }
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = stop;
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  /* Drain twice per FIFO fill so scheduling jitter does not overflow it */
+  uint32_t interval = period * (FXAS21002C_FIFO_DEPTH / 2) / 1000;
+  gyroRawData_t fifo[FXAS21002C_FIFO_DEPTH];
+  gyroSample_t samples[FXAS21002C_FIFO_DEPTH];
+  uint32_t published = 0, overflows = 0, errors = 0;
+
+  gyro.readFIFO(fifo, FXAS21002C_FIFO_DEPTH); /* Discard the backlog */
+  while (!stopping) {
+    delay(interval);
+    uint8_t n = gyro.readFIFO(fifo, FXAS21002C_FIFO_DEPTH);
+    uint32_t now = micros();
+    if (gyro.getFIFOOverflow())
+      overflows++;
+    if (!n && bus.lastError())
+      errors++;
+
+    /* The newest sample was taken around 'now', older ones one period
+     * apart, as FXAS21002C_Acquisition stamps them */
+    for (uint8_t i = 0; i < n; i++) {
+      samples[i].timestamp = now - (n - 1 - i) * period;
+      samples[i].data = fifo[i];
+    }
+    ring.publish(samples, n);
+    published += n;
+  }
+
+  fprintf(stderr, "%u samples published, %u FIFO overflows, %u bus errors\n",
+          published, overflows, errors);
+  ring.end();
+  if (unlinkOnExit)
+    FXAS21002C_ShmRing::unlink(name);
+  return 0;
+}
@@ -0,0 +1,173 @@
+/*!
+ * @file fxas21002c_streamrx.cpp
+ *
+ * Linux receiver for the binary stream of examples/binary_stream: puts a
+ * serial port in raw mode, feeds every byte to FXAS21002C_StreamDecoder
+ * and prints the link statistics once a second. Build from the repository
+ * root:
+ *
+ *   g++ -I. extras/streamrx/fxas21002c_streamrx.cpp FXAS21002C_Stream.cpp \
+ *       -o fxas21002c_streamrx
+ *
+ * Usage:
+ *
+ *   fxas21002c_streamrx [-b 115200] [-s] /dev/ttyACM0
+ *
+ * -s also writes every sample to stdout as "timestamp,x,y,z" lines; the
+ * statistics go to stderr.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Stream.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Set by SIGINT or SIGTERM */
+static volatile sig_atomic_t stopping = 0;
+
+/** Signal handler asking the main loop to finish */
+static void stop(int sig) {
+  (void)sig;
+  stopping = 1;
+}
+
+/** Prints the usage line and exits */
+static void usage(const char *self) {
+  fprintf(stderr, "usage: %s [-b baud] [-s] device\n", self);
+  exit(2);
+}
+
+/** Maps a baud rate to its termios constant, B0 if unsupported */
+static speed_t baudConstant(long baud) {
+  switch (baud) {
+  case 9600:
+    return B9600;
+  case 19200:
+    return B19200;
+  case 38400:
+    return B38400;
+  case 57600:
+    return B57600;
+  case 115200:
+    return B115200;
+  case 230400:
+    return B230400;
+  case 460800:
+    return B460800;
+  case 921600:
+    return B921600;
+  default:
+    return B0;
+  }
+}
+
+/** Opens 'device' as a raw 8N1 port, returns the descriptor or -1 */
+static int openPort(const char *device, speed_t speed) {
+  int fd = open(device, O_RDONLY | O_NOCTTY);
+  if (fd < 0)
+    return -1;
+
+  struct termios tio;
+  if (tcgetattr(fd, &tio) < 0) {
+    close(fd);
+    return -1;
+  }
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cflag &= ~CRTSCTS;
+  /* Block until at least one byte arrives or 100 ms pass, so the
+   * statistics keep printing on a silent link */
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 1;
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+    close(fd);
+    return -1;
+  }
+  tcflush(fd, TCIFLUSH);
+  return fd;
+}
+
+/** Prints the decoder's counters on one line */
+static void printStats(const fxasStreamStats_t *s) {
+  fprintf(stderr,
+          "frames %u samples %u crc %u framing %u lost frames %u "
+          "lost samples %u\n",
+          s->frames, s->samples, s->crcErrors, s->framingErrors,
+          s->lostFrames, s->lostSamples);
+}
+
+int main(int argc, char **argv) {
+  long baud = 115200;
+  bool printSamples = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "b:s")) != -1) {
+    switch (opt) {
+    case 'b':
+      baud = strtol(optarg, NULL, 0);
+      break;
+    case 's':
+      printSamples = true;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  speed_t speed = baudConstant(baud);
+  if ((optind != argc - 1) || (speed == B0))
+    usage(argv[0]);
+
+  const char *device = argv[optind];
+  int fd = openPort(device, speed);
+  if (fd < 0) {
+    fprintf(stderr, "%s: %s\n", device, strerror(errno));
+    return 1;
+  }
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = stop;
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  FXAS21002C_StreamDecoder decoder;
+  gyroSample_t samples[FXAS21002C_STREAM_MAX_SAMPLES];
+  uint8_t buf[256];
+  time_t lastPrint = time(NULL);
+  while (!stopping) {
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if ((n < 0) && (errno != EINTR)) {
+      fprintf(stderr, "%s: %s\n", device, strerror(errno));
+      break;
+    }
+    for (ssize_t i = 0; i < n; i++) {
+      if (!decoder.push(buf[i]) || !printSamples)
+        continue;
+      uint8_t count = decoder.getSamples(samples);
+      for (uint8_t k = 0; k < count; k++)
+        printf("%u,%d,%d,%d\n", samples[k].timestamp, samples[k].data.x,
+               samples[k].data.y, samples[k].data.z);
+    }
+
+    time_t now = time(NULL);
+    if (now != lastPrint) {
+      lastPrint = now;
+      printStats(decoder.getStats());
+    }
+  }
+
+  printStats(decoder.getStats());
+  close(fd);
+  return 0;
+}
@@ -0,0 +1,141 @@
+/*!
+ * @file acquisition_test.cpp
+ *
+ * Host test of FXAS21002C_Acquisition's task mode: begin() starts a task
+ * that owns the simulated sensor while the main thread only reads the
+ * ring. The task runs on a thread through the FreeRTOS stand-in in
+ * extras/test/freertos and on the simulation's virtual time. Build and
+ * run from the repository root, with Adafruit_Sensor.h on the include
+ * path:
+ *
+ *   g++ -DFXAS21002C_FREERTOS -I. -Iextras/test/freertos \
+ *       -I<Adafruit_Sensor> extras/test/acquisition_test.cpp \
+ *       Adafruit_FXAS21002C.cpp FXAS21002C_Acquisition.cpp \
+ *       FXAS21002C_Host.cpp FXAS21002C_SampleRing.cpp FXAS21002C_Sim.cpp \
+ *       FXAS21002C_Trace.cpp -pthread -o acquisition_test
+ *   ./acquisition_test
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Acquisition.h"
+#include "FXAS21002C_Sim.h"
+
+#include <atomic>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+static int failures;
+
+/** Reports a failed check */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                   \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+/** Virtual time runs this many times faster than real time in tasks */
+#define SPEEDUP (20)
+
+static std::atomic<bool> stopTasks(false);
+static pthread_t taskThread;
+
+/** Task entry point and argument, handed to the task's thread */
+struct taskStart_s {
+  TaskFunction_t code;
+  void *parameters;
+};
+
+/** Thread body running a task function */
+static void *runTask(void *arg) {
+  taskStart_s start = *(taskStart_s *)arg;
+  delete (taskStart_s *)arg;
+  start.code(start.parameters);
+  return NULL;
+}
+
+/** FreeRTOS stand-in: starts the task on a thread */
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name,
+                       uint32_t stackDepth, void *parameters,
+                       UBaseType_t priority, TaskHandle_t *created) {
+  (void)name;
+  (void)stackDepth;
+  (void)priority;
+  taskStart_s *start = new taskStart_s{code, parameters};
+  if (pthread_create(&taskThread, NULL, runTask, start) != 0) {
+    delete start;
+    return pdFAIL;
+  }
+  if (created)
+    *created = NULL;
+  return pdPASS;
+}
+
+/** FreeRTOS stand-in: waits on the FXAS21002C_Clock, or ends the task */
+void vTaskDelay(TickType_t ticks) {
+  if (stopTasks.load(std::memory_order_acquire))
+    pthread_exit(NULL);
+  /* Virtual time for the sensor, a fraction of it in real time so the
+   * reader thread gets to run */
+  delay(ticks);
+  struct timespec ts = {0, (long)ticks * 1000000L / SPEEDUP};
+  nanosleep(&ts, NULL);
+}
+
+int main() {
+  FXAS21002C_Sim sim;
+  FXAS21002C_Clock::set(&sim);
+  Adafruit_FXAS21002C gyro;
+  CHECK(gyro.begin(sim));
+  gyro.setODR(GYRO_ODR_800HZ);
+  sim.setRate(100, 0, 0);
+  delay(100);
+
+  static gyroSample_t buffer[256];
+  FXAS21002C_Acquisition acq(gyro, buffer, 256);
+
+  /* From here on only the task touches the sensor and the clock */
+  CHECK(acq.begin());
+
+  uint32_t count = 0;
+  uint32_t last = 0;
+  uint32_t backwards = 0;
+  uint32_t wrongRate = 0;
+  while (count < 1600) {
+    gyroSample_t sample;
+    if (!acq.read(&sample)) {
+      struct timespec ts = {0, 1000000L};
+      nanosleep(&ts, NULL);
+      continue;
+    }
+    if (count && (int32_t)(sample.timestamp - last) <= 0)
+      backwards++;
+    if (sample.data.x != 12800) /* 100 dps at 250 dps full scale */
+      wrongRate++;
+    last = sample.timestamp;
+    count++;
+  }
+  CHECK(backwards == 0);
+  CHECK(wrongRate == 0);
+
+  /* The unified sensor interface reads from the ring as well */
+  sensors_event_t event;
+  while (!acq.getEvent(&event)) {
+    struct timespec ts = {0, 1000000L};
+    nanosleep(&ts, NULL);
+  }
+  CHECK(fabsf(event.gyro.x - 100 * SENSORS_DPS_TO_RADS) < 0.01F);
+
+  stopTasks.store(true, std::memory_order_release);
+  pthread_join(taskThread, NULL);
+  CHECK(acq.overruns() == 0);
+  CHECK(sim.violations() == 0);
+  printf("%u samples from the acquisition task\n", count);
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,36 @@
+/*!
+ * @file FreeRTOS.h
+ *
+ * Minimal stand-in for the FreeRTOS kernel header, backed by POSIX
+ * threads, covering only what FXAS21002C_Acquisition uses. It lets
+ * extras/test/acquisition_test.cpp run the FXAS21002C_FREERTOS task path
+ * without a FreeRTOS port; a real port (e.g. the POSIX one) is used the
+ * same way, by putting its headers on the include path.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_TEST_FREERTOS_H__
+#define __FXAS21002C_TEST_FREERTOS_H__
+
+#include <stdint.h>
+
+/** Tick count, one tick per millisecond */
+typedef uint32_t TickType_t;
+/** Signed base type */
+typedef long BaseType_t;
+/** Unsigned base type */
+typedef unsigned long UBaseType_t;
+/** Opaque task handle */
+typedef void *TaskHandle_t;
+/** Task entry point */
+typedef void (*TaskFunction_t)(void *);
+
+/** Success */
+#define pdPASS (1)
+/** Failure */
+#define pdFAIL (0)
+/** Milliseconds to ticks */
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#endif
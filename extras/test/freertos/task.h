@@ -0,0 +1,21 @@
+/*!
+ * @file task.h
+ *
+ * Task API of the minimal FreeRTOS stand-in, see FreeRTOS.h. Tasks are
+ * threads; vTaskDelay() lets the delay pass on the FXAS21002C_Clock, so a
+ * simulation clock makes tasks run on virtual time.
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#ifndef __FXAS21002C_TEST_TASK_H__
+#define __FXAS21002C_TEST_TASK_H__
+
+#include "FreeRTOS.h"
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name,
+                       uint32_t stackDepth, void *parameters,
+                       UBaseType_t priority, TaskHandle_t *created);
+void vTaskDelay(TickType_t ticks);
+
+#endif
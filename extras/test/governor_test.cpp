@@ -0,0 +1,109 @@
+/*!
+ * @file governor_test.cpp
+ *
+ * Host test of FXAS21002C_Governor against FXAS21002C_Sim, on virtual
+ * time: stepping down at rest, holding the rate inside the hysteresis
+ * band, jumping up on motion and keeping timestamps monotonic. Build and
+ * run from the repository root, with Adafruit_Sensor.h on the include
+ * path:
+ *
+ *   g++ -I. -I<Adafruit_Sensor> extras/test/governor_test.cpp \
+ *       Adafruit_FXAS21002C.cpp FXAS21002C_Governor.cpp \
+ *       FXAS21002C_Host.cpp FXAS21002C_Sim.cpp FXAS21002C_Trace.cpp \
+ *       -o governor_test
+ *   ./governor_test
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Governor.h"
+#include "FXAS21002C_Sim.h"
+
+#include <stdio.h>
+
+static int failures;
+
+/** Reports a failed check */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                   \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+/** dps per LSB at the 250 dps range */
+#define DPS_PER_LSB (0.0078125F)
+
+static FXAS21002C_Sim sim;
+static Adafruit_FXAS21002C gyro;
+static FXAS21002C_Governor governor(gyro);
+static uint32_t last;
+static bool started;
+static uint32_t backwards;
+
+/** Polls every 20 ms for 'ms' of virtual time, checking the timestamps */
+static void run(uint32_t ms) {
+  gyroSample_t samples[FXAS21002C_FIFO_DEPTH];
+  for (uint32_t t = 0; t < ms; t += 20) {
+    delay(20);
+    uint8_t n = governor.poll(samples, FXAS21002C_FIFO_DEPTH);
+    for (uint8_t i = 0; i < n; i++) {
+      if (started && (int32_t)(samples[i].timestamp - last) <= 0)
+        backwards++;
+      last = samples[i].timestamp;
+      started = true;
+    }
+  }
+}
+
+int main() {
+  FXAS21002C_Clock::set(&sim);
+  sim.setNoise(4);
+  CHECK(gyro.begin(sim));
+
+  /* Starts at the highest rate */
+  CHECK(governor.begin(GYRO_ODR_12_5HZ, GYRO_ODR_800HZ));
+  CHECK(governor.getODR() == GYRO_ODR_800HZ);
+  CHECK(governor.getPeriod() == 1250);
+
+  /* At rest it steps down one level per 2 s hold time */
+  run(5000);
+  float odr = governor.getODR();
+  CHECK(odr < GYRO_ODR_800HZ && odr > GYRO_ODR_12_5HZ);
+
+  /* A steady turn between the rate thresholds (64 and 128 LSB) changes
+   * nothing, however long it lasts */
+  uint32_t switches = governor.switches();
+  sim.setRate(0, 0, 96 * DPS_PER_LSB);
+  run(20000);
+  CHECK(governor.getODR() == odr);
+  CHECK(governor.switches() == switches);
+
+  /* Back at rest it steps down to the slowest rate */
+  sim.setRate(0, 0, 0);
+  run(20000);
+  CHECK(governor.getODR() == GYRO_ODR_12_5HZ);
+  CHECK(gyro.getPeriodUs() == 80000);
+
+  /* Motion above the high threshold jumps straight to the highest rate,
+   * within one period of the slowest rate plus a poll */
+  sim.setRate(10, 0, 0);
+  run(120);
+  CHECK(governor.getODR() == GYRO_ODR_800HZ);
+  switches = governor.switches();
+  run(5000);
+  CHECK(governor.getODR() == GYRO_ODR_800HZ);
+  CHECK(governor.switches() == switches);
+
+  /* And steps down again once the motion stops */
+  sim.setRate(0, 0, 0);
+  run(20000);
+  CHECK(governor.getODR() == GYRO_ODR_12_5HZ);
+
+  CHECK(backwards == 0);
+  CHECK(sim.violations() == 0);
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+/*!
+ * @file health_test.cpp
+ *
+ * Host test of FXAS21002C_Health against FXAS21002C_Sim: the self-test
+ * deflection and the samples it marks, with direct reads and with FIFO
+ * drains. Build and run from the repository root, with Adafruit_Sensor.h
+ * on the include path:
+ *
+ *   g++ -I. -I<Adafruit_Sensor> extras/test/health_test.cpp \
+ *       Adafruit_FXAS21002C.cpp FXAS21002C_Health.cpp FXAS21002C_Host.cpp \
+ *       FXAS21002C_Sim.cpp FXAS21002C_Trace.cpp -o health_test
+ *   ./health_test
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Health.h"
+#include "FXAS21002C_Sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int failures;
+
+/** Reports a failed check */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                   \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+/** Self-test output change the model applies while ST is set */
+#define RESPONSE 8000
+/** Largest plausible sample at rest, far below RESPONSE */
+#define REST_LIMIT 200
+
+/** Samples returned as valid that still carried the deflection */
+static uint32_t leaked;
+
+/** Checks one sample and counts a deflected one let through */
+static void check(FXAS21002C_Health &health, const gyroRawData_t &s) {
+  if (health.addSample(s) &&
+      (abs(s.x) > REST_LIMIT || abs(s.y) > REST_LIMIT ||
+       abs(s.z) > REST_LIMIT))
+    leaked++;
+}
+
+/** Verifies the outcome of one completed self-test */
+static void verify(FXAS21002C_Health &health) {
+  const gyroHealth_t *h = health.getHealth();
+  CHECK(h->selfTests == 1);
+  CHECK(h->selfTestFail == 0);
+  for (uint8_t i = 0; i < 3; i++)
+    CHECK(abs(h->selfTest[i] - RESPONSE) < 50);
+  CHECK(leaked == 0);
+  CHECK(health.healthy());
+}
+
+int main() {
+  FXAS21002C_Sim sim;
+  FXAS21002C_Clock::set(&sim);
+  sim.setNoise(4);
+  sim.setSelfTestResponse(RESPONSE);
+  Adafruit_FXAS21002C gyro;
+  CHECK(gyro.begin(sim));
+
+  /* Direct reads, one per sample period: no latency */
+  {
+    FXAS21002C_Health health(gyro);
+    gyroRawData_t raw;
+    leaked = 0;
+    health.startSelfTest();
+    for (uint16_t i = 0; i < 200; i++) {
+      delay(10);
+      CHECK(gyro.readRaw(&raw));
+      check(health, raw);
+    }
+    verify(health);
+  }
+
+  /* FIFO drains every 30 ms at 800 Hz: samples queue up to a FIFO deep
+   * ahead of addSample() */
+  {
+    FXAS21002C_Health health(gyro);
+    gyroRawData_t fifo[FXAS21002C_FIFO_DEPTH];
+    gyro.setODR(GYRO_ODR_800HZ);
+    gyro.setFIFOMode(GYRO_FIFO_CIRCULAR);
+    delay(100);
+    gyro.readFIFO(fifo, FXAS21002C_FIFO_DEPTH);
+    health.setSelfTestLatency(FXAS21002C_FIFO_DEPTH);
+    leaked = 0;
+    health.startSelfTest();
+    for (uint16_t i = 0; i < 40; i++) {
+      delay(30);
+      uint8_t n = gyro.readFIFO(fifo, FXAS21002C_FIFO_DEPTH);
+      CHECK(!gyro.getFIFOOverflow());
+      for (uint8_t k = 0; k < n; k++)
+        check(health, fifo[k]);
+    }
+    verify(health);
+  }
+
+  CHECK(sim.violations() == 0);
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/*!
+ * @file linux_i2c_test.cpp
+ *
+ * Host test of FXAS21002C_LinuxI2C against a fake i2c-dev adapter. The
+ * test defines ioctl() itself, which takes precedence over the C
+ * library's, and answers I2C_RDWR and I2C_SMBUS requests from a register
+ * array, so the real transfer code runs without a kernel driver. Build and
+ * run from the repository root, with Adafruit_Sensor.h on the include
+ * path (or add -DFXAS21002C_NO_FLOAT):
+ *
+ *   g++ -I. -I<Adafruit_Sensor> extras/test/linux_i2c_test.cpp \
+ *       Adafruit_FXAS21002C.cpp FXAS21002C_Host.cpp \
+ *       FXAS21002C_LinuxI2C.cpp FXAS21002C_Trace.cpp -o linux_i2c_test
+ *   ./linux_i2c_test
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "Adafruit_FXAS21002C.h"
+#include "FXAS21002C_LinuxI2C.h"
+
+#include <errno.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+static uint8_t regs[0x40];      ///< Fake device register file
+static bool smbusOnly = false;  ///< Reject I2C_RDWR like i2c-stub does
+static int rdwrCalls, smbusCalls;
+static int failures;
+
+/** Reports a failed check */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                   \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+/**************************************************************************/
+/*!
+    @brief  Fake i2c-dev adapter: register address auto-increments like on
+            the sensor
+*/
+/**************************************************************************/
+extern "C" int ioctl(int fd, unsigned long request, ...) {
+  (void)fd;
+  va_list ap;
+  va_start(ap, request);
+  void *arg = va_arg(ap, void *);
+  va_end(ap);
+
+  if (request == I2C_SLAVE)
+    return 0;
+
+  if (request == I2C_RDWR) {
+    if (smbusOnly) {
+      errno = EOPNOTSUPP;
+      return -1;
+    }
+    rdwrCalls++;
+    struct i2c_rdwr_ioctl_data *d = (struct i2c_rdwr_ioctl_data *)arg;
+    uint8_t reg = d->msgs[0].buf[0];
+    if (d->nmsgs == 1) {
+      for (int i = 1; i < d->msgs[0].len; i++)
+        regs[(reg + i - 1) & 0x3F] = d->msgs[0].buf[i];
+      return 1;
+    }
+    /* A burst read must be write + read joined by a repeated start */
+    CHECK(d->nmsgs == 2);
+    CHECK(!(d->msgs[0].flags & I2C_M_RD) && (d->msgs[1].flags & I2C_M_RD));
+    for (int i = 0; i < d->msgs[1].len; i++)
+      d->msgs[1].buf[i] = regs[(reg + i) & 0x3F];
+    return 2;
+  }
+
+  if (request == I2C_SMBUS) {
+    smbusCalls++;
+    struct i2c_smbus_ioctl_data *d = (struct i2c_smbus_ioctl_data *)arg;
+    if (d->read_write == I2C_SMBUS_WRITE) {
+      regs[d->command & 0x3F] = d->data->byte;
+      return 0;
+    }
+    for (int i = 0; i < d->data->block[0]; i++)
+      d->data->block[1 + i] = regs[(d->command + i) & 0x3F];
+    return 0;
+  }
+
+  errno = ENOTTY;
+  return -1;
+}
+
+int main() {
+  for (int pass = 0; pass < 2; pass++) {
+    smbusOnly = pass;
+    rdwrCalls = smbusCalls = 0;
+    memset(regs, 0, sizeof(regs));
+    regs[GYRO_REGISTER_WHO_AM_I] = FXAS21002C_ID;
+    regs[GYRO_REGISTER_OUT_X_MSB] = 0x12;
+    regs[GYRO_REGISTER_OUT_X_MSB + 1] = 0x34;
+    regs[GYRO_REGISTER_OUT_X_MSB + 5] = 0xFF;
+
+    FXAS21002C_LinuxI2C bus;
+    CHECK(bus.begin("/dev/null"));
+    Adafruit_FXAS21002C gyro;
+    CHECK(gyro.begin(bus));
+    gyro.setRange(GYRO_RANGE_500DPS);
+    CHECK((regs[GYRO_REGISTER_CTRL_REG0] & 0x03) == 0x02);
+
+    gyroRawData_t raw;
+    CHECK(gyro.readRaw(&raw));
+    CHECK(raw.x == 0x1234);
+    CHECK(raw.z == 0x00FF);
+
+    /* A full FIFO drain is longer than one SMBus block */
+    regs[GYRO_REGISTER_F_STATUS] = FXAS21002C_FIFO_DEPTH;
+    gyroRawData_t fifo[FXAS21002C_FIFO_DEPTH];
+    CHECK(gyro.readFIFO(fifo, FXAS21002C_FIFO_DEPTH) ==
+          FXAS21002C_FIFO_DEPTH);
+
+    CHECK(bus.smbus() == smbusOnly);
+    if (smbusOnly)
+      CHECK(smbusCalls > 0);
+    else
+      CHECK(rdwrCalls > 0 && smbusCalls == 0);
+    printf("%s: %d I2C_RDWR, %d SMBus transfers\n",
+           smbusOnly ? "smbus" : "i2c_rdwr", rdwrCalls, smbusCalls);
+  }
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
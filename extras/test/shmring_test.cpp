@@ -0,0 +1,183 @@
+/*!
+ * @file shmring_test.cpp
+ *
+ * Host test of FXAS21002C_ShmRing: in-order delivery, a reader that falls
+ * behind, writer restarts (same and larger capacity) and a concurrent
+ * writer process that restarts while the reader follows it. Build and run
+ * from the repository root on Linux:
+ *
+ *   g++ -I. extras/test/shmring_test.cpp FXAS21002C_ShmRing.cpp -lrt \
+ *       -o shmring_test
+ *   ./shmring_test
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_ShmRing.h"
+
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static int failures;
+
+/** Reports a failed check */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                   \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+/** Samples the concurrent writer publishes per generation */
+#define STREAM_SAMPLES (200000)
+
+/** Sample number 'i', with data derived from it to detect torn copies */
+static gyroSample_t make(uint32_t i) {
+  gyroSample_t s;
+  s.timestamp = i;
+  s.data.x = (int16_t)i;
+  s.data.y = (int16_t)(i >> 16);
+  s.data.z = (int16_t)~i;
+  return s;
+}
+
+/** Checks that a sample is intact */
+static bool intact(const gyroSample_t &s) {
+  return s.data.x == (int16_t)s.timestamp &&
+         s.data.y == (int16_t)(s.timestamp >> 16) &&
+         s.data.z == (int16_t)~s.timestamp;
+}
+
+/** Publishes samples first to first + count - 1 in bursts */
+static void publish(FXAS21002C_ShmRing &ring, uint32_t first, uint32_t count) {
+  gyroSample_t burst[32];
+  while (count) {
+    uint16_t n = count > 32 ? 32 : count;
+    for (uint16_t i = 0; i < n; i++)
+      burst[i] = make(first + i);
+    ring.publish(burst, n);
+    first += n;
+    count -= n;
+  }
+}
+
+/** Reads everything available, checking that it continues at 'next' */
+static uint32_t drain(FXAS21002C_ShmRing &ring, uint32_t next) {
+  gyroSample_t s;
+  uint32_t n = 0;
+  while (ring.read(&s)) {
+    CHECK(intact(s));
+    CHECK(s.timestamp == next + n);
+    n++;
+  }
+  return n;
+}
+
+int main() {
+  char name[32];
+  snprintf(name, sizeof(name), "/fxas21002c_test_%d", (int)getpid());
+  FXAS21002C_ShmRing writer, reader;
+
+  /* Readers only see samples published after attach() */
+  CHECK(!reader.attach(name));
+  CHECK(writer.create(name, 100, 1250)); /* rounded down to 64 */
+  publish(writer, 0, 5);
+  CHECK(reader.attach(name));
+  CHECK(reader.period() == 1250);
+  CHECK(reader.available() == 0);
+  publish(writer, 5, 10);
+  CHECK(reader.available() == 10);
+  CHECK(drain(reader, 5) == 10);
+  CHECK(reader.overruns() == 0);
+
+  /* A reader that falls behind skips to the oldest sample in the ring */
+  publish(writer, 15, 200);
+  CHECK(reader.available() == 63);
+  CHECK(drain(reader, 215 - 63) == 63);
+  CHECK(reader.overruns() == 200 - 63);
+
+  /* Push the cursor far past anything a new ring starts with */
+  publish(writer, 215, 100000);
+  CHECK(drain(reader, 215 + 100000 - 63) == 63);
+  uint32_t overruns = reader.overruns();
+  CHECK(overruns == 200 - 63 + 100000 - 63);
+
+  /* Writer restart: the reader follows the new ring from its start
+   * without counting the old cursor against it */
+  CHECK(writer.create(name, 64, 2500));
+  publish(writer, 0, 20);
+  CHECK(reader.available() == 20);
+  CHECK(drain(reader, 0) == 20);
+  CHECK(reader.restarts() == 1);
+  CHECK(reader.overruns() == overruns);
+  CHECK(reader.period() == 2500);
+
+  /* Restart with a larger ring: the reader maps the grown object */
+  CHECK(writer.create(name, 1024));
+  publish(writer, 0, 1000);
+  CHECK(reader.available() == 1000); /* capacity 1024 */
+  CHECK(drain(reader, 0) == 1000);
+  CHECK(reader.restarts() == 2);
+  CHECK(reader.overruns() == overruns);
+
+  /* A smaller ring reuses the object without shrinking it */
+  CHECK(writer.create(name, 16));
+  publish(writer, 0, 40);
+  CHECK(drain(reader, 40 - 15) == 15);
+  CHECK(reader.restarts() == 3);
+  CHECK(reader.overruns() == overruns + 40 - 15);
+  writer.end();
+
+  /* A concurrent writer process that restarts halfway: every sample the
+   * reader gets is intact and in order within its generation */
+  reader.end();
+  CHECK(writer.create(name, 256));
+  CHECK(reader.attach(name));
+  writer.end();
+  pid_t pid = fork();
+  if (pid == 0) {
+    FXAS21002C_ShmRing child;
+    for (uint8_t g = 0; g < 2; g++) {
+      if (!child.create(name, 256))
+        _exit(1);
+      publish(child, 0, STREAM_SAMPLES);
+    }
+    _exit(0);
+  }
+  uint32_t got = 0, torn = 0, disorder = 0;
+  uint32_t restarts = 0;
+  uint32_t next = 0;
+  int status = 0;
+  bool done = false;
+  while (!done) {
+    done = waitpid(pid, &status, WNOHANG) == pid;
+    gyroSample_t s;
+    while (reader.read(&s)) {
+      if (reader.restarts() != restarts) {
+        restarts = reader.restarts();
+        next = 0;
+      }
+      if (!intact(s))
+        torn++;
+      if (s.timestamp < next)
+        disorder++;
+      next = s.timestamp + 1;
+      got++;
+    }
+  }
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  CHECK(torn == 0);
+  CHECK(disorder == 0);
+  CHECK(got + reader.overruns() <= 2 * STREAM_SAMPLES);
+  CHECK(next == STREAM_SAMPLES);
+  printf("stream: %u read, %u overruns, %u restarts\n", got,
+         reader.overruns(), reader.restarts());
+
+  reader.end();
+  FXAS21002C_ShmRing::unlink(name);
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
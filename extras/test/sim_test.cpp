@@ -0,0 +1,161 @@
+/*!
+ * @file sim_test.cpp
+ *
+ * Host test of the driver against FXAS21002C_Sim, on virtual time. Build
+ * and run from the repository root, with Adafruit_Sensor.h on the include
+ * path:
+ *
+ *   g++ -I. -I<Adafruit_Sensor> extras/test/sim_test.cpp \
+ *       Adafruit_FXAS21002C.cpp FXAS21002C_Host.cpp FXAS21002C_Sim.cpp \
+ *       FXAS21002C_Trace.cpp -o sim_test
+ *   ./sim_test
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Sim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static int failures;
+
+/** Reports a failed check */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                   \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+/** Z axis turns at 100 dps for the first second, then stops */
+static void spinThenStop(uint64_t us, float *dps) {
+  dps[0] = 0;
+  dps[1] = 0;
+  dps[2] = (us < 1000000) ? 100 : 0;
+}
+
+int main() {
+  FXAS21002C_Sim sim;
+  FXAS21002C_Clock::set(&sim);
+  Adafruit_FXAS21002C gyro;
+
+  /* begin(): ID check, reset, 250 dps, Active at 100 Hz */
+  CHECK(gyro.begin(sim));
+  CHECK(sim.peek(GYRO_REGISTER_CTRL_REG1) == 0x0E);
+  CHECK((sim.peek(GYRO_REGISTER_CTRL_REG0) & 0x03) == 0x03);
+
+  /* getEvent() at 500 dps full scale */
+  gyro.setRange(GYRO_RANGE_500DPS);
+  CHECK((sim.peek(GYRO_REGISTER_CTRL_REG0) & 0x03) == 0x02);
+  sim.setRate(100, 0, -50);
+  delay(100); /* 60 ms start-up after the Standby cycle, plus 1/ODR */
+  sensors_event_t event;
+  CHECK(gyro.getEvent(&event));
+  CHECK(fabsf(event.gyro.x - 100 * SENSORS_DPS_TO_RADS) < 0.01F);
+  CHECK(fabsf(event.gyro.z + 50 * SENSORS_DPS_TO_RADS) < 0.01F);
+
+  /* setODR(): samples per virtual second */
+  gyro.setODR(GYRO_ODR_800HZ);
+  CHECK(gyro.getPeriodUs() == 1250);
+  delay(100);
+  uint32_t before = sim.samples();
+  delay(1000);
+  CHECK(sim.samples() - before == 800);
+
+  /* Circular FIFO: overflows and keeps the newest 32 samples */
+  gyroRawData_t fifo[FXAS21002C_FIFO_DEPTH];
+  gyro.setFIFOMode(GYRO_FIFO_CIRCULAR);
+  delay(200);
+  CHECK(gyro.readFIFO(fifo, FXAS21002C_FIFO_DEPTH) == FXAS21002C_FIFO_DEPTH);
+  CHECK(gyro.getFIFOOverflow());
+  delay(10);
+  uint8_t n = gyro.readFIFO(fifo, FXAS21002C_FIFO_DEPTH);
+  CHECK(n >= 8 && n < 16); /* plus those taken during the 32 sample burst */
+  CHECK(!gyro.getFIFOOverflow());
+
+  /* Stop mode: holds the oldest 32 samples */
+  gyro.setFIFOMode(GYRO_FIFO_STOP);
+  delay(200);
+  CHECK(gyro.getFIFOCount() == FXAS21002C_FIFO_DEPTH);
+  CHECK(gyro.getFIFOOverflow());
+
+  /* Watermark interrupt on INT1, released by draining */
+  gyro.setFIFOMode(GYRO_FIFO_CIRCULAR, 24);
+  CHECK(gyro.enableFIFOInterrupt(GYRO_INT_PIN_1));
+  while (!sim.interrupt(1))
+    delayMicroseconds(100);
+  CHECK(!sim.interrupt(2));
+  CHECK(gyro.readFIFO(fifo, FXAS21002C_FIFO_DEPTH) >= 24);
+  CHECK(!sim.interrupt(1));
+  gyro.disableFIFOInterrupt();
+  gyro.setFIFOMode(GYRO_FIFO_DISABLED);
+
+  /* Data ready flag, cleared by reading the sample */
+  uint8_t status;
+  delay(100);
+  CHECK(gyro.readRaw(&gyro.raw));
+  sim.readRegisters(GYRO_REGISTER_DR_STATUS, &status, 1);
+  CHECK(status == 0);
+  delay(5);
+  sim.readRegisters(GYRO_REGISTER_DR_STATUS, &status, 1);
+  CHECK(status == 0xFF);
+
+  /* TEMP */
+  int8_t temp;
+  sim.setTemperature(-5);
+  sim.readRegisters(GYRO_REGISTER_TEMP, (uint8_t *)&temp, 1);
+  CHECK(temp == -5);
+
+  /* Bounded retry recovers from a NAK */
+  gyroRawData_t raw;
+  gyro.setRetryPolicy(2);
+  sim.failTransfers(1);
+  CHECK(gyro.readRaw(&raw));
+  CHECK(gyro.getErrorStats()->recovered == 1);
+  sim.failTransfers(3);
+  CHECK(!gyro.readRaw(&raw));
+
+  /* Runtime ODR change through Ready mode */
+  CHECK(gyro.setODRFast(GYRO_ODR_100HZ));
+  CHECK(gyro.getPeriodUs() == 10000);
+  before = sim.samples();
+  delay(1000);
+  CHECK(sim.samples() - before >= 99 && sim.samples() - before <= 100);
+
+  /* A time dependent rate */
+  sim.setRateSource(spinThenStop);
+  gyro.setRange(GYRO_RANGE_250DPS);
+  delay(100);
+  CHECK(gyro.readRaw(&raw));
+  CHECK(raw.z == 0);
+
+  /* No write the datasheet forbids in Active mode */
+  CHECK(sim.violations() == 0);
+
+  /* Throughput: one virtual minute of 800 Hz FIFO drains */
+  gyro.setODR(GYRO_ODR_800HZ);
+  gyro.setFIFOMode(GYRO_FIFO_CIRCULAR);
+  delay(100);
+  gyro.readFIFO(fifo, FXAS21002C_FIFO_DEPTH);
+  struct timespec t0, t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  uint64_t start = sim.now();
+  uint32_t drained = 0;
+  while (sim.now() - start < 60000000ULL) {
+    delay(20);
+    drained += gyro.readFIFO(fifo, FXAS21002C_FIFO_DEPTH);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  double wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+  int32_t due = (int32_t)((sim.now() - start) / 1250);
+  CHECK(abs((int32_t)drained - due) <= FXAS21002C_FIFO_DEPTH);
+  printf("60 s virtual: %u samples, %u transfers, %.3f s wall\n", drained,
+         sim.transfers(), wall);
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+/*!
+ * @file stream_test.cpp
+ *
+ * Host test of the binary stream format: round trips through
+ * FXAS21002C_Stream and FXAS21002C_StreamDecoder, and the decoder's
+ * statistics for a corrupted byte, a dropped frame, a sequence gap and a
+ * lost delimiter. Build and run from the repository root:
+ *
+ *   g++ -I. extras/test/stream_test.cpp FXAS21002C_Stream.cpp \
+ *       -o stream_test
+ *   ./stream_test
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "FXAS21002C_Stream.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int failures;
+
+/** Reports a failed check */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                   \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+/** Samples per frame */
+#define COUNT 8
+/** Sample period in us, 800 Hz */
+#define PERIOD 1250
+
+static FXAS21002C_Stream stream;
+static FXAS21002C_StreamDecoder decoder;
+/** Index of the next sample the sender produces */
+static uint32_t produced;
+
+/** One encoded frame */
+struct frame_s {
+  uint8_t bytes[FXAS21002C_STREAM_MAX_FRAME(COUNT)];
+  size_t len;
+};
+
+/** Sample number 'i', with values that include 0x00 bytes and negatives */
+static gyroRawData_t make(uint32_t i) {
+  gyroRawData_t s;
+  s.x = (int16_t)(i * 7);
+  s.y = (int16_t)(-(int32_t)i);
+  s.z = (int16_t)(i << 8);
+  return s;
+}
+
+/** Encodes the next COUNT samples */
+static frame_s next() {
+  gyroRawData_t samples[COUNT];
+  for (uint8_t i = 0; i < COUNT; i++)
+    samples[i] = make(produced + i);
+  frame_s f;
+  f.len = stream.encode(samples, COUNT, 1000000 + produced * PERIOD, PERIOD,
+                        f.bytes, sizeof(f.bytes));
+  produced += COUNT;
+  return f;
+}
+
+/** Feeds a frame, returning how many bytes completed a valid frame */
+static int feed(const frame_s &f) {
+  int valid = 0;
+  for (size_t i = 0; i < f.len; i++)
+    valid += decoder.push(f.bytes[i]);
+  return valid;
+}
+
+/** Checks that the decoder holds the frame starting at sample 'first' */
+static void expect(uint32_t first) {
+  gyroSample_t out[FXAS21002C_STREAM_MAX_SAMPLES];
+  CHECK(decoder.getSamples(out) == COUNT);
+  for (uint8_t i = 0; i < COUNT; i++) {
+    gyroRawData_t s = make(first + i);
+    CHECK(out[i].timestamp == 1000000 + (first + i) * PERIOD);
+    CHECK(out[i].data.x == s.x && out[i].data.y == s.y &&
+          out[i].data.z == s.z);
+  }
+}
+
+int main() {
+  const fxasStreamStats_t *st = decoder.getStats();
+
+  /* Clean link, past a sequence number wrap */
+  for (uint16_t i = 0; i < 300; i++) {
+    uint32_t first = produced;
+    CHECK(feed(next()) == 1);
+    expect(first);
+  }
+  CHECK(st->frames == 300 && st->samples == 300 * COUNT);
+  CHECK(st->lostFrames == 0 && st->lostSamples == 0);
+  CHECK(st->crcErrors == 0 && st->framingErrors == 0);
+
+  /* The samples survive the first bytes of the following frame */
+  uint32_t first = produced;
+  CHECK(feed(next()) == 1);
+  frame_s f = next();
+  for (size_t i = 0; i + 1 < f.len; i++)
+    CHECK(!decoder.push(f.bytes[i]));
+  expect(first);
+  CHECK(decoder.push(0x00));
+  expect(first + COUNT);
+
+  /* A corrupted byte drops its frame only; the next one counts it lost */
+  decoder.reset();
+  f = next();
+  CHECK(feed(f) == 1);
+  f = next();
+  f.bytes[f.len / 2] ^= (f.bytes[f.len / 2] == 0x01) ? 0x02 : 0x01;
+  CHECK(feed(f) == 0);
+  gyroSample_t out[FXAS21002C_STREAM_MAX_SAMPLES];
+  CHECK(decoder.getSamples(out) == 0);
+  CHECK(st->crcErrors + st->framingErrors == 1);
+  first = produced;
+  CHECK(feed(next()) == 1);
+  expect(first);
+  CHECK(st->frames == 2);
+  CHECK(st->lostFrames == 1 && st->lostSamples == COUNT);
+
+  /* A frame that never arrives */
+  decoder.reset();
+  CHECK(feed(next()) == 1);
+  next();
+  CHECK(feed(next()) == 1);
+  CHECK(st->lostFrames == 1 && st->lostSamples == COUNT);
+  CHECK(st->crcErrors == 0 && st->framingErrors == 0);
+
+  /* A sequence gap of several frames */
+  decoder.reset();
+  CHECK(feed(next()) == 1);
+  for (uint8_t i = 0; i < 5; i++)
+    next();
+  first = produced;
+  CHECK(feed(next()) == 1);
+  expect(first);
+  CHECK(st->lostFrames == 5 && st->lostSamples == 5 * COUNT);
+
+  /* A lost delimiter merges two frames into one malformed one */
+  decoder.reset();
+  CHECK(feed(next()) == 1);
+  f = next();
+  f.len--;
+  CHECK(feed(f) == 0);
+  CHECK(feed(next()) == 0);
+  CHECK(st->crcErrors + st->framingErrors == 1);
+  first = produced;
+  CHECK(feed(next()) == 1);
+  expect(first);
+  CHECK(st->lostFrames == 2 && st->lostSamples == 2 * COUNT);
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
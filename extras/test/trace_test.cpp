@@ -0,0 +1,185 @@
+/*!
+ * @file trace_test.cpp
+ *
+ * Host test of FXAS21002C_Trace: records a session on FXAS21002C_Sim,
+ * replays it bit-exact without a single bus transfer, and checks that a
+ * write the trace does not hold and a truncated trace make the replay
+ * diverge. Build and run from the repository root, with Adafruit_Sensor.h
+ * on the include path:
+ *
+ *   g++ -I. -I<Adafruit_Sensor> extras/test/trace_test.cpp \
+ *       Adafruit_FXAS21002C.cpp FXAS21002C_Host.cpp FXAS21002C_Sim.cpp \
+ *       FXAS21002C_Trace.cpp -o trace_test
+ *   ./trace_test
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+#include "Adafruit_FXAS21002C.h"
+#include "FXAS21002C_Sim.h"
+#include "FXAS21002C_Trace.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int failures;
+
+/** Reports a failed check */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);                   \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+/** Direct reads in the session */
+#define READS 50
+/** FIFO drains in the session */
+#define DRAINS 10
+
+/** Print that keeps everything written to it in memory */
+class TraceBuffer : public Print {
+public:
+  size_t write(uint8_t b) {
+    if (len >= sizeof(data))
+      return 0;
+    data[len++] = b;
+    return 1;
+  }
+  using Print::write;
+
+  uint8_t data[32768]; ///< The trace
+  size_t len = 0;      ///< Bytes written
+};
+
+/** Everything the driver returned during one session */
+struct session_s {
+  bool begun;
+  gyroRawData_t raw[READS];
+  bool rawOk[READS];
+  gyroRawData_t fifo[DRAINS][FXAS21002C_FIFO_DEPTH];
+  uint8_t drained[DRAINS];
+  float event[3];
+};
+
+/** Runs the same driver calls whether 'gyro' is on the model or on a
+ * replayed trace */
+static void run(Adafruit_FXAS21002C &gyro, FXAS21002C_Transport &bus,
+                session_s *s) {
+  memset(s, 0, sizeof(*s));
+  s->begun = gyro.begin(bus);
+  gyro.setRange(GYRO_RANGE_500DPS);
+  gyro.setODR(GYRO_ODR_400HZ);
+  for (uint8_t i = 0; i < READS; i++) {
+    delay(3);
+    s->rawOk[i] = gyro.readRaw(&s->raw[i]);
+  }
+  gyro.setFIFOMode(GYRO_FIFO_CIRCULAR);
+  for (uint8_t i = 0; i < DRAINS; i++) {
+    delay(20);
+    s->drained[i] = gyro.readFIFO(s->fifo[i], FXAS21002C_FIFO_DEPTH);
+  }
+  gyro.setFIFOMode(GYRO_FIFO_DISABLED);
+  sensors_event_t event;
+  gyro.getEvent(&event);
+  s->event[0] = event.gyro.x;
+  s->event[1] = event.gyro.y;
+  s->event[2] = event.gyro.z;
+}
+
+static TraceBuffer buffer;
+static session_s recorded, replayed;
+/** Clock for the replays, unrelated to the recording's model */
+static FXAS21002C_Sim replayClock;
+
+int main() {
+  /* Record a session on the model, with noise so every sample differs */
+  {
+    FXAS21002C_Sim sim;
+    FXAS21002C_Clock::set(&sim);
+    sim.setRate(30, -60, 90);
+    sim.setNoise(20);
+    FXAS21002C_Trace trace;
+    Adafruit_FXAS21002C gyro;
+    gyro.setTrace(&trace);
+    trace.beginRecord(buffer);
+    run(gyro, sim, &recorded);
+    CHECK(trace.recording());
+    CHECK(recorded.begun);
+    CHECK(sim.transfers() > READS + DRAINS);
+    uint16_t samples = 0;
+    for (uint8_t i = 0; i < DRAINS; i++)
+      samples += recorded.drained[i];
+    CHECK(samples > DRAINS * 4);
+    CHECK(buffer.len < sizeof(buffer.data));
+    trace.end();
+  }
+
+  /* Replay against a model that must never see a transfer, on a clock
+   * that runs differently from the recording's */
+  {
+    FXAS21002C_Sim idle;
+    replayClock.setBusSpeed(100000);
+    FXAS21002C_Clock::set(&replayClock);
+    FXAS21002C_Trace trace;
+    trace.beginReplay(buffer.data, buffer.len);
+    Adafruit_FXAS21002C gyro;
+    gyro.setTrace(&trace);
+    run(gyro, idle, &replayed);
+    CHECK(!trace.diverged());
+    CHECK(trace.position() == buffer.len);
+    CHECK(idle.transfers() == 0);
+    CHECK(memcmp(&recorded, &replayed, sizeof(recorded)) == 0);
+  }
+
+  /* A write the trace does not hold diverges at that record, and every
+   * later transaction fails */
+  {
+    FXAS21002C_Sim idle;
+    FXAS21002C_Trace trace;
+    trace.beginReplay(buffer.data, buffer.len);
+    Adafruit_FXAS21002C gyro;
+    gyro.setTrace(&trace);
+    CHECK(gyro.begin(idle));
+    CHECK(!trace.diverged());
+    size_t pos = trace.position();
+    gyro.setRange(GYRO_RANGE_2000DPS);
+    CHECK(trace.diverged());
+    CHECK(trace.position() > pos && trace.position() < buffer.len);
+    gyroRawData_t raw;
+    CHECK(!gyro.readRaw(&raw));
+    CHECK(idle.transfers() == 0);
+  }
+
+  /* A truncated trace replays up to its last complete record */
+  {
+    FXAS21002C_Sim idle;
+    FXAS21002C_Trace trace;
+    trace.beginReplay(buffer.data, buffer.len - 3);
+    Adafruit_FXAS21002C gyro;
+    gyro.setTrace(&trace);
+    run(gyro, idle, &replayed);
+    CHECK(trace.diverged());
+    CHECK(trace.position() < buffer.len - 3);
+    CHECK(memcmp(replayed.fifo, recorded.fifo, sizeof(recorded.fifo)) == 0);
+    CHECK(memcmp(replayed.raw, recorded.raw, sizeof(recorded.raw)) == 0);
+    CHECK(idle.transfers() == 0);
+  }
+
+  /* A trace cut inside its header is rejected outright */
+  {
+    FXAS21002C_Sim idle;
+    FXAS21002C_Trace trace;
+    trace.beginReplay(buffer.data, 3);
+    CHECK(trace.diverged());
+    Adafruit_FXAS21002C gyro;
+    gyro.setTrace(&trace);
+    CHECK(!gyro.begin(idle));
+    CHECK(idle.transfers() == 0);
+  }
+
+  printf("%u byte trace\n", (unsigned)buffer.len);
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}